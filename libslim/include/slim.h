@@ -30,6 +30,8 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #define __ELM_H__
 
 #include <nds/disc_io.h>
+#include <stddef.h>
+#include <sys/types.h>
 
 #ifdef __cplusplus
 extern "C"
@@ -112,6 +114,240 @@ extern "C"
    */
   bool configureCache(uint32_t cacheSize);
 
+  /**
+   * Configures the allocator used for every heap allocation made by libslim,
+   * including the sector cache, working buffers, and directory handles.
+   * Passing NULL for either function restores malloc or free respectively.
+   * 
+   * LFN working buffers and fast seek tables are taken from a fixed pool of
+   * FF_MEM_POOL_BLOCKS blocks first, and only use the allocator when the pool is exhausted.
+   * 
+   * This must be called before configureCache and before calling any method that 
+   * initializes or mounts a FAT device. Returns false if libslim has already 
+   * allocated memory, in which case the allocator is not changed.
+   */
+  bool configureAllocator(void *(*alloc)(size_t size), void (*free)(void *ptr));
+
+  /**
+   * Configures the function used to discard sectors on the device mounted at `mount`,
+   * for devices that support TRIM or erase commands. DISC_INTERFACE has no discard 
+   * function, so it is configured separately. Passing NULL disables discards.
+   * 
+   * Once configured, the clusters freed by deleting or truncating files are discarded
+   * in batches of contiguous sectors when the volume is synced. Returns false if the
+   * mount point is invalid.
+   */
+  bool configureDiscard(const char *mount, bool (*discard)(sec_t sector, sec_t numSectors));
+
+  /**
+   * Configures the logical sector size in bytes of the device mounted at `mount`,
+   * for devices that do not use 512 byte sectors.
+   * 
+   * The sector size must be a power of 2 between FF_MIN_SS and FF_MAX_SS, so libslim 
+   * must be built with FF_MAX_SS raised to support larger sectors. This must be 
+   * called before the device is mounted. Returns false if the mount point or sector 
+   * size is invalid.
+   */
+  bool configureSectorSize(const char *mount, uint16_t sectorSize);
+
+  /**
+   * Configures the largest number of sectors the IO driver of the device mounted at
+   * `mount` can transfer in a single request. Larger reads and writes are split into
+   * requests of `maxSectors` sectors, so big sequential transfers reach the device as
+   * the largest commands it accepts. Passing 0 removes the limit, which is the default.
+   * 
+   * Returns false if the mount point is invalid.
+   */
+  bool configureMaxSectors(const char *mount, uint32_t maxSectors);
+
+// File systems for fatFormat
+#define FORMAT_FAT    0x01 // FAT12 or FAT16, whichever fits
+#define FORMAT_FAT32  0x02 // FAT32
+#define FORMAT_EXFAT  0x04 // exFAT
+
+  /**
+   * Options for fatFormat. Any field left as 0 is picked from the size of the device.
+   */
+  typedef struct fat_format_s
+  {
+    // One of FORMAT_FAT, FORMAT_FAT32 or FORMAT_EXFAT, or 0 to pick the file system
+    // the SD Association recommends for an SD card of the same size.
+    uint8_t type;
+    // Size of the device in sectors, or 0 to use the size of the partition table
+    // or volume already on the device.
+    uint32_t sectorCount;
+    // Erase block size in bytes that the FAT and data area are aligned to.
+    uint32_t eraseBlockSize;
+    // Cluster size in bytes.
+    uint32_t clusterSize;
+    // Formats the device without a partition table.
+    bool noPartition;
+  } FAT_FORMAT;
+
+  /**
+   * Formats the device mounted at `mount` and mounts the new volume.
+   * 
+   * The partition, FAT and data area are all aligned to the erase block size, so 
+   * cluster sized writes never straddle an erase block. By default the erase block 
+   * and cluster sizes follow the SD Association recommendations, which are picked 
+   * for write throughput. This is a quick format: only the boot sectors, FAT and 
+   * root directory are written, and the data area is left as is unless a discard
+   * function was configured with configureDiscard.
+   * 
+   * If `interface` is NULL, the DISC_INTERFACE the mount point was previously mounted 
+   * with is used. Pass NULL for `options` to use the defaults. The volume is unmounted 
+   * first, and any open files on it are lost.
+   * 
+   * Returns false if the device could not be formatted or mounted, or if `interface`
+   * differs from the one the mount point was previously mounted with.
+   */
+  bool fatFormat(const char *mount, const DISC_INTERFACE *interface, const FAT_FORMAT *options);
+
+  /**
+   * An open directory for batched enumeration.
+   */
+  typedef struct fat_dir_s FAT_DIR;
+
+  /**
+   * A directory entry returned by fatReadDirBatch.
+   */
+  typedef struct fat_dirent_s
+  {
+    // UTF-8 name of the entry, stored in the names buffer passed to fatReadDirBatch.
+    const char *name;
+    // Size of the file in bytes
+    uint64_t size;
+    // Start cluster of the file or directory, 0 for empty files.
+    uint32_t cluster;
+    // Date of last modification, in FAT format (bits 15-9: year from 1980, 8-5: month, 4-0: day)
+    uint16_t date;
+    // Time of last modification, in FAT format (bits 15-11: hour, 10-5: minute, 4-0: second / 2)
+    uint16_t time;
+    // FAT attributes (ATTR_*)
+    uint8_t attr;
+  } FAT_DIRENT;
+
+  /**
+   * Opens a directory for batched enumeration.
+   * 
+   * Returns NULL and sets errno on failure. The directory must be closed with fatCloseDir.
+   */
+  FAT_DIR *fatOpenDir(const char *path);
+
+  /**
+   * Opens a directory for batched enumeration of the entries matching pattern.
+   * 
+   * The pattern is matched case-insensitively against the long name of each entry,
+   * where `?` matches any character and `*` matches any sequence of characters.
+   * Entries are matched before their names are converted, and patterns of the form
+   * `*.ext` are matched against the raw directory entries, so filtering a large
+   * directory for e.g. `*.nds` is much faster than filtering the results of readdir.
+   * 
+   * If pattern is NULL, every entry is returned as with fatOpenDir.
+   * Returns NULL and sets errno on failure. The directory must be closed with fatCloseDir.
+   */
+  FAT_DIR *fatOpenDirFiltered(const char *path, const char *pattern);
+
+  /**
+   * Reads up to count entries of the directory into entries, in directory order.
+   * 
+   * The names of the entries are packed into the names buffer of namesSize bytes, and
+   * stay valid until the buffer is reused. Entries are read until either count entries
+   * were read, the names buffer is full, or the end of the directory is reached.
+   * 
+   * Unlike readdir, no stat buffer is built and no path is converted per entry, so
+   * a whole directory can be listed with one call per batch.
+   * 
+   * If an error occurs after some entries were read, those entries are returned, and
+   * the error is reported by the next call. An entry whose name can not be converted
+   * to UTF-8 is skipped with EILSEQ, and later calls continue with the next entry.
+   * 
+   * Returns the number of entries read, 0 at the end of the directory, or -1 with
+   * errno set on failure.
+   */
+  int fatReadDirBatch(FAT_DIR *dir, FAT_DIRENT *entries, int count, char *names, size_t namesSize);
+
+  /**
+   * Rewinds the directory to its first entry.
+   * 
+   * Returns 0 on success, or -1 with errno set on failure.
+   */
+  int fatRewindDir(FAT_DIR *dir);
+
+  /**
+   * Closes a directory opened with fatOpenDir.
+   * 
+   * Returns 0 on success, or -1 with errno set on failure.
+   */
+  int fatCloseDir(FAT_DIR *dir);
+
+  typedef struct fat_file_s FAT_FILE;
+
+  /**
+   * Opens a file without going through stdio or the devoptab file table.
+   * 
+   * flags are the same O_* flags as for open. The handle has no stream buffer
+   * and no file descriptor, so reads and writes go straight to FatFs; reading
+   * or writing whole sectors at a time bypasses the sector cache entirely.
+   * 
+   * Returns NULL and sets errno on failure. The file must be closed with fatClose.
+   */
+  FAT_FILE *fatOpen(const char *path, int flags);
+
+  /**
+   * Reads up to len bytes from the current position of the file into buf.
+   * 
+   * Returns the number of bytes read, 0 at the end of the file, or -1 with
+   * errno set on failure.
+   */
+  ssize_t fatRead(FAT_FILE *file, void *buf, size_t len);
+
+  /**
+   * Writes len bytes from buf to the current position of the file.
+   * 
+   * Returns the number of bytes written, or -1 with errno set on failure.
+   */
+  ssize_t fatWrite(FAT_FILE *file, const void *buf, size_t len);
+
+  /**
+   * Moves the position of the file as with lseek. Seeking past the end of
+   * a file opened for writing extends the file.
+   * 
+   * Returns the new position, or -1 with errno set on failure.
+   */
+  int64_t fatSeek(FAT_FILE *file, int64_t offset, int whence);
+
+  /**
+   * Reads up to len bytes from offset into buf as with pread, without moving
+   * the position of the file.
+   * 
+   * The cluster at offset is found from the fast seek map if there is one, and otherwise
+   * by walking the cluster chain from the end of the previous positional access or
+   * the position of the file, whichever is closer. Sequential positional reads, such as
+   * those of a stream sharing a handle with other readers, never walk from the start.
+   * 
+   * Returns the number of bytes read, 0 at or past the end of the file, or -1 with
+   * errno set on failure.
+   */
+  ssize_t fatReadAt(FAT_FILE *file, void *buf, size_t len, int64_t offset);
+
+  /**
+   * Writes len bytes from buf to offset as with pwrite, without moving the
+   * position of the file. The file is extended if offset is past its end.
+   * 
+   * The offset is used even if the file was opened with O_APPEND.
+   * 
+   * Returns the number of bytes written, or -1 with errno set on failure.
+   */
+  ssize_t fatWriteAt(FAT_FILE *file, const void *buf, size_t len, int64_t offset);
+
+  /**
+   * Closes the file and frees the handle.
+   * 
+   * Returns 0 on success, or -1 with errno set on failure.
+   */
+  int fatClose(FAT_FILE *file);
+
 // File attributes
 #define ATTR_ARCHIVE    0x20   // Archive
 #define ATTR_DIRECTORY  0x10 // Directory
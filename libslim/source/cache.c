@@ -29,6 +29,7 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <ctype.h>
 #include "tonccpy.h"
 #include "memcopy.h"
+#include "lock.h"
 
 #include "ff.h"
 
@@ -84,15 +85,38 @@ typedef struct cache_s
     BYTE valid;
     BYTE pdrv;
     LBA_t sector;
+    // Number of file buffers referring to this block. Pinned blocks are never evicted.
+    BYTE pins;
+    // Sector size of the cached sector in bytes
+    WORD size;
 } __attribute__((aligned(4))) CACHE;
 
-static DTCM_DATA int _evictCounter = 0;
+typedef struct cache_shard_s
+{
+    // Index of the first block of the shard, and its number of blocks
+    UINT first;
+    UINT size;
+    // GCLOCK hand, relative to first
+    UINT hand;
+#if FF_FS_REENTRANT
+    // Odd while the blocks of the shard are being modified. Hits are read
+    // without the lock, and retried if seq changed while reading.
+    UINT seq;
+#endif
+    SLIM_LOCK lock;
+} CACHE_SHARD;
+
+static DTCM_DATA CACHE_SHARD _shards[SLIM_CACHE_SHARDS];
+static UINT _shardCount = 0;
 
 static CACHE *__cache = NULL;
 static UINT _cacheSize = 0;
 static BOOL _cacheDisabled = false;
 
-void cache_cpy(const void *src, const void *dst);
+// Only guards cache_init. Every volume shares the cache, and FatFs only locks
+// each volume, so the blocks are guarded by the lock of their shard.
+static SLIM_LOCK _cacheLock = SLIM_LOCK_INIT;
+
 
 static void mem_cpy(void *dst, const void *src, UINT cnt)
 {
@@ -110,15 +134,11 @@ static void mem_cpy(void *dst, const void *src, UINT cnt)
 
 CACHE *cache_init(UINT cacheSize)
 {
-    // Cache was previously disabled
-    if (_cacheDisabled)
-    {
-        return NULL;
-    }
-
-    // Cache was previously initialized
-    if (__cache)
+    slim_lock(&_cacheLock);
+    // Cache was previously disabled, or initialized
+    if (_cacheDisabled || __cache)
     {
+        slim_unlock(&_cacheLock);
         return __cache;
     }
 
@@ -128,31 +148,141 @@ CACHE *cache_init(UINT cacheSize)
     if (cacheSize == 0)
     {
         _cacheDisabled = true;
+        slim_unlock(&_cacheLock);
         return NULL;
     }
 
     CACHE *allocedCache = ff_memalloc(sizeof(CACHE) * cacheSize);
-    if (allocedCache == NULL)
+    if (allocedCache != NULL)
     {
-        return NULL;
+        MEMCLR(allocedCache, sizeof(CACHE) * cacheSize);
+
+        _shardCount = MAX(1, MIN(SLIM_CACHE_SHARDS, cacheSize / SLIM_CACHE_SHARD_MIN));
+        for (UINT i = 0; i < _shardCount; i++)
+        {
+            _shards[i].first = i * cacheSize / _shardCount;
+            _shards[i].size = (i + 1) * cacheSize / _shardCount - _shards[i].first;
+            _shards[i].hand = 0;
+            slim_lock_init(&_shards[i].lock);
+        }
+        __cache = allocedCache;
     }
-    else
+    slim_unlock(&_cacheLock);
+    return allocedCache;
+}
+
+// Gets the shard the specified sector is cached in.
+static inline CACHE_SHARD *cache_shard_of(BYTE drv, LBA_t sector)
+{
+#if SLIM_CACHE_SHARDS > 1
+    // Consecutive sectors are spread over every shard.
+    DWORD hash = ((DWORD)sector ^ ((DWORD)drv << 24)) * 0x9E3779B1;
+    return &_shards[(hash >> 16) % _shardCount];
+#else
+    (void)drv;
+    (void)sector;
+    return &_shards[0];
+#endif
+}
+
+// Gets the shard block i belongs to.
+static inline CACHE_SHARD *cache_shard_of_block(int i)
+{
+    CACHE_SHARD *shard = &_shards[0];
+    while ((UINT)i >= shard->first + shard->size)
+        shard++;
+    return shard;
+}
+
+static inline void shard_lock(CACHE_SHARD *shard)
+{
+    slim_lock(&shard->lock);
+#if FF_FS_REENTRANT
+    __atomic_store_n(&shard->seq, shard->seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+#endif
+}
+
+static inline void shard_unlock(CACHE_SHARD *shard)
+{
+#if FF_FS_REENTRANT
+    __atomic_store_n(&shard->seq, shard->seq + 1, __ATOMIC_RELEASE);
+#endif
+    slim_unlock(&shard->lock);
+}
+
+#if FF_FS_REENTRANT
+// Waits until the shard is not being modified, and returns its sequence number.
+static inline UINT shard_read_begin(CACHE_SHARD *shard)
+{
+    UINT seq;
+    while ((seq = __atomic_load_n(&shard->seq, __ATOMIC_ACQUIRE)) & 1)
+        ;
+    return seq;
+}
+
+// Returns true if the shard was modified since shard_read_begin returned seq.
+static inline BOOL shard_read_retry(CACHE_SHARD *shard, UINT seq)
+{
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    return __atomic_load_n(&shard->seq, __ATOMIC_RELAXED) != seq;
+}
+#endif
+
+static inline void cache_set_valid(CACHE *cache, int i, BYTE valid)
+{
+#ifdef DTCM_CACHEINFO
+    if (i < DTCM_CACHEINFO_MAX)
     {
-        __cache = allocedCache;
+        _cacheInfo[i].valid = valid;
+        _cacheInfo[i].pdrv = cache[i].pdrv;
+        _cacheInfo[i].sector = cache[i].sector;
     }
+#endif
+    cache[i].valid = valid;
+}
+
+// Gets the index of the block whose data starts at ptr.
+// Returns -1 if ptr is not the data of a block.
+static inline int cache_block_of(CACHE *cache, const BYTE *ptr)
+{
+    if (!cache || (const BYTE *)ptr < (const BYTE *)cache || (const BYTE *)ptr >= (const BYTE *)&cache[_cacheSize])
+        return -1;
+    UINT i = ((const BYTE *)ptr - (const BYTE *)cache) / sizeof(CACHE);
+    return (const BYTE *)cache[i].data == ptr ? (int)i : -1;
+}
 
-    MEMCLR(__cache, sizeof(CACHE) * cacheSize);
-    return __cache;
+// Finds a block of the shard to store a new sector in with GCLOCK, skipping pinned blocks.
+// Returns -1 if every block of the shard is pinned.
+static int cache_alloc_block(CACHE *cache, CACHE_SHARD *shard)
+{
+    UINT pinned = 0;
+    while (pinned < shard->size)
+    {
+        int i = shard->first + shard->hand;
+        shard->hand = ((shard->hand + 1) % shard->size);
+        if (cache[i].pins)
+        {
+            pinned++;
+            continue;
+        }
+        pinned = 0;
+        if (!cache[i].valid || !cache[i].weight)
+            return i;
+        // Decrement weight
+        cache[i].weight -= 1;
+    }
+    return -1;
 }
 
-// Finds the block with the given drv and sector
+// Finds the block with the given drv and sector in its shard
 // Returns -1 if none can be found.
-static inline int cache_find_valid_block(CACHE *cache, BYTE drv, LBA_t sector)
+static inline int cache_find_valid_block(CACHE *cache, CACHE_SHARD *shard, BYTE drv, LBA_t sector)
 {
     if (!cache)
         return -1;
 
-    for (int i = 0; i < _cacheSize; i++)
+    for (int i = shard->first; i < shard->first + shard->size; i++)
     {
 #ifdef DTCM_CACHEINFO
         if (i < DTCM_CACHEINFO_MAX &&
@@ -170,16 +300,47 @@ static inline int cache_find_valid_block(CACHE *cache, BYTE drv, LBA_t sector)
     return -1;
 }
 
+static inline void cache_copy_out(CACHE *cache, int i, BYTE *dst, UINT size)
+{
+    int oldIME = enterCriticalSection();
+    if (!(((uint32_t)dst) & 0x3))
+    {
+        // dst is aligned
+        cache_cpy(&cache[i].data, dst, size);
+    }
+    else
+    {
+        mem_cpy(dst, &cache[i].data, size);
+    }
+    leaveCriticalSection(oldIME);
+}
+
 BOOL cache_load_sector(CACHE *cache, BYTE drv, LBA_t sector, BYTE *dst)
 {
     if (!cache)
         return false;
 
+    CACHE_SHARD *shard = cache_shard_of(drv, sector);
     int i = -1;
-    if ((i = cache_find_valid_block(cache, drv, sector)) == -1)
+#if FF_FS_REENTRANT
+    UINT seq;
+    do
     {
+        seq = shard_read_begin(shard);
+        if ((i = cache_find_valid_block(cache, shard, drv, sector)) == -1)
+            return false;
+        // The size must belong to the block that was found before copying that many bytes.
+        UINT size = cache[i].size;
+        if (shard_read_retry(shard, seq))
+            continue;
+        cache_copy_out(cache, i, dst, size);
+    } while (shard_read_retry(shard, seq));
+
+    // Increase weight. A lost update only makes eviction slightly less accurate.
+    __atomic_fetch_add(&cache[i].weight, 1, __ATOMIC_RELAXED);
+#else
+    if ((i = cache_find_valid_block(cache, shard, drv, sector)) == -1)
         return false;
-    }
 
 #ifdef DEBUG_NOGBA
     // char block[256];
@@ -188,42 +349,35 @@ BOOL cache_load_sector(CACHE *cache, BYTE drv, LBA_t sector, BYTE *dst)
 #endif
     // Increase weight
     cache[i].weight += 1;
-    int oldIME = enterCriticalSection();
-    if (!(((uint32_t)dst) & 0x3))
-    {
-        // dst is aligned
-        cache_cpy(&cache[i].data, dst);
-    }
-    else
-    {
-        mem_cpy(dst, &cache[i].data, FF_MAX_SS);
-    }
-    leaveCriticalSection(oldIME);
+    cache_copy_out(cache, i, dst, cache[i].size);
+#endif
     return true;
 }
 
-void cache_store_sector(CACHE *cache, BYTE drv, LBA_t sector, const BYTE *src, BYTE weight)
+void cache_store_sector(CACHE *cache, BYTE drv, LBA_t sector, const BYTE *src, UINT ssize, BYTE weight)
 {
     if (!cache || _cacheSize == 0)
         return;
 
-    // Invalidate sector if exists
-    cache_invalidate_sector(__cache, drv, sector);
-
-    int free_block = -1;
-
-    while (free_block < 0)
+    CACHE_SHARD *shard = cache_shard_of(drv, sector);
+    shard_lock(shard);
+    // Invalidate sector if exists. A pinned block may hold data newer than src, so keep it instead.
+    int i = cache_find_valid_block(cache, shard, drv, sector);
+    if (i != -1)
     {
-        if (!cache[_evictCounter].valid || !cache[_evictCounter].weight)
-        {
-            free_block = _evictCounter;
-        }
-        else
+        if (cache[i].pins)
         {
-            // Decrement weight
-            cache[_evictCounter].weight -= 1;
+            shard_unlock(shard);
+            return;
         }
-        _evictCounter = ((_evictCounter + 1) % _cacheSize);
+        cache_set_valid(cache, i, 0);
+    }
+
+    int free_block = cache_alloc_block(cache, shard);
+    if (free_block < 0)
+    {
+        shard_unlock(shard);
+        return;
     }
 
 #ifdef DEBUG_NOGBA
@@ -233,48 +387,41 @@ void cache_store_sector(CACHE *cache, BYTE drv, LBA_t sector, const BYTE *src, B
 #endif
 
     // Set valid and unreferenced
-    cache[free_block].valid = 1;
     cache[free_block].pdrv = drv;
     cache[free_block].sector = sector;
     cache[free_block].weight = weight;
-
-#ifdef DTCM_CACHEINFO
-    if (free_block < DTCM_CACHEINFO_MAX)
-    {
-        _cacheInfo[free_block].valid = 1;
-        _cacheInfo[free_block].pdrv = drv;
-        _cacheInfo[free_block].sector = sector;
-    }
-#endif
+    cache[free_block].size = ssize;
+    cache_set_valid(cache, free_block, 1);
 
 #if SLIM_CACHE_STORE_CPY
-    DC_FlushRange(src, FF_MAX_SS);
+    DC_FlushRange(src, ssize);
     // Perform safe cache flush
     uint32_t dst = (uint32_t)&cache[free_block].data;
     if (dst % CACHE_LINE_SIZE)
         DC_FlushRange((void *)(dst), 1);
-    if ((dst + FF_MAX_SS) % CACHE_LINE_SIZE)
-        DC_FlushRange((void *)(dst + FF_MAX_SS), 1);
+    if ((dst + ssize) % CACHE_LINE_SIZE)
+        DC_FlushRange((void *)(dst + ssize), 1);
 #endif
 
 #if SLIM_CACHE_STORE_CPY == 1
-    dmaCopyWords(3, src, &cache[free_block].data, FF_MAX_SS);
-    DC_InvalidateRange(&cache[free_block].data, FF_MAX_SS);
+    dmaCopyWords(3, src, &cache[free_block].data, ssize);
+    DC_InvalidateRange(&cache[free_block].data, ssize);
 #elif SLIM_CACHE_STORE_CPY == 2
     if (isDSiMode())
     {
-        ndmaCopyWords(0, src, &cache[free_block].data, FF_MAX_SS);
-        DC_InvalidateRange(&cache[free_block].data, FF_MAX_SS);
+        ndmaCopyWords(0, src, &cache[free_block].data, ssize);
+        DC_InvalidateRange(&cache[free_block].data, ssize);
     }
     else
     {
-        MEMCOPY(&cache[free_block].data, src, FF_MAX_SS);
+        MEMCOPY(&cache[free_block].data, src, ssize);
     }
 #else
     int oldIME = enterCriticalSection();
-    cache_cpy(src, &(cache[free_block].data));
+    cache_cpy(src, &(cache[free_block].data), ssize);
     leaveCriticalSection(oldIME);
 #endif
+    shard_unlock(shard);
 }
 
 BOOL cache_invalidate_sector(CACHE *cache, BYTE drv, LBA_t sector)
@@ -282,31 +429,123 @@ BOOL cache_invalidate_sector(CACHE *cache, BYTE drv, LBA_t sector)
     if (!cache)
         return false;
 
+    CACHE_SHARD *shard = cache_shard_of(drv, sector);
+    shard_lock(shard);
     int i = -1;
-    if ((i = cache_find_valid_block(cache, drv, sector)) != -1)
+    if ((i = cache_find_valid_block(cache, shard, drv, sector)) != -1)
     {
-#ifdef DTCM_CACHEINFO
-        if (i < DTCM_CACHEINFO_MAX)
+        cache_set_valid(cache, i, 0);
+    }
+    shard_unlock(shard);
+    return i != -1;
+}
+
+void cache_write_sector(CACHE *cache, BYTE drv, LBA_t sector, const BYTE *src, UINT ssize)
+{
+    if (!cache)
+        return;
+
+    // Every block of the sector, including a reserved src, is in the same shard.
+    CACHE_SHARD *shard = cache_shard_of(drv, sector);
+    shard_lock(shard);
+    int self = cache_block_of(cache, src);
+    for (int i = shard->first; i < shard->first + shard->size; i++)
+    {
+        if (i == self || cache[i].pdrv != drv || cache[i].sector != sector || !cache[i].valid)
+            continue;
+        if (cache[i].pins)
         {
-            _cacheInfo[i].valid = 0;
+            // Another file buffer refers to this sector, keep it coherent.
+            int oldIME = enterCriticalSection();
+            cache_cpy(src, &cache[i].data, ssize);
+            leaveCriticalSection(oldIME);
+        }
+        else
+        {
+            cache_set_valid(cache, i, 0);
         }
-#endif
-        cache[i].valid = 0;
-        return true;
     }
 
-    return false;
+    // A reserved block becomes valid once its data has been written.
+    if (self != -1 && cache[self].pdrv == drv && cache[self].sector == sector)
+        cache_set_valid(cache, self, 1);
+    shard_unlock(shard);
 }
 
-BITMAP_PRIMITIVE cache_get_existence_bitmap(CACHE *cache, BYTE drv, LBA_t sector, BYTE count)
+BYTE *cache_pin_sector(CACHE *cache, BYTE drv, LBA_t sector)
 {
     if (!cache)
-        return 0;
-    if (count > SECTORS_PER_CHUNK)
-        return 0;
+        return NULL;
+
+    CACHE_SHARD *shard = cache_shard_of(drv, sector);
+    shard_lock(shard);
+    int i = cache_find_valid_block(cache, shard, drv, sector);
+    if (i != -1)
+    {
+        cache[i].weight += 1;
+        cache[i].pins++;
+    }
+    shard_unlock(shard);
+    return i != -1 ? cache[i].data : NULL;
+}
+
+BYTE *cache_reserve_sector(CACHE *cache, BYTE drv, LBA_t sector, UINT ssize)
+{
+    if (!cache || _cacheSize == 0)
+        return NULL;
+
+    CACHE_SHARD *shard = cache_shard_of(drv, sector);
+    shard_lock(shard);
+    int i = cache_alloc_block(cache, shard);
+    if (i >= 0)
+    {
+        cache[i].pdrv = drv;
+        cache[i].sector = sector;
+        cache[i].weight = 2;
+        cache[i].pins = 1;
+        cache[i].size = ssize;
+        cache_set_valid(cache, i, 0);
+    }
+    shard_unlock(shard);
+    return i >= 0 ? cache[i].data : NULL;
+}
+
+BOOL cache_unpin_sector(CACHE *cache, const BYTE *data)
+{
+    int i = cache_block_of(cache, data);
+    if (i == -1)
+        return false;
+    CACHE_SHARD *shard = cache_shard_of_block(i);
+    shard_lock(shard);
+    if (cache[i].pins)
+        cache[i].pins--;
+    shard_unlock(shard);
+    return true;
+}
+
+void cache_discard_sectors(CACHE *cache, BYTE drv, LBA_t start, LBA_t end)
+{
+    if (!cache)
+        return;
+
+    for (UINT s = 0; s < _shardCount; s++)
+    {
+        CACHE_SHARD *shard = &_shards[s];
+        shard_lock(shard);
+        for (int i = shard->first; i < shard->first + shard->size; i++)
+        {
+            if (cache[i].valid && !cache[i].pins && cache[i].pdrv == drv && cache[i].sector >= start && cache[i].sector <= end)
+                cache_set_valid(cache, i, 0);
+        }
+        shard_unlock(shard);
+    }
+}
 
+// Sets the bits of the sectors between sector and sector + count that are cached in the shard.
+static inline BITMAP_PRIMITIVE cache_shard_bitmap(CACHE *cache, CACHE_SHARD *shard, BYTE drv, LBA_t sector, BYTE count)
+{
     BITMAP_PRIMITIVE bitmap = 0;
-    for (int i = 0; i < _cacheSize; i++)
+    for (int i = shard->first; i < shard->first + shard->size; i++)
     {
 #ifdef DTCM_CACHEINFO
         if (i < DTCM_CACHEINFO_MAX && _cacheInfo[i].valid && _cacheInfo[i].pdrv == drv)
@@ -328,4 +567,31 @@ BITMAP_PRIMITIVE cache_get_existence_bitmap(CACHE *cache, BYTE drv, LBA_t sector
     }
     return bitmap;
 }
-#endif
\ No newline at end of file
+
+BITMAP_PRIMITIVE cache_get_existence_bitmap(CACHE *cache, BYTE drv, LBA_t sector, BYTE count)
+{
+    if (!cache)
+        return 0;
+    if (count > SECTORS_PER_CHUNK)
+        return 0;
+
+    BITMAP_PRIMITIVE bitmap = 0;
+    for (UINT s = 0; s < _shardCount; s++)
+    {
+        CACHE_SHARD *shard = &_shards[s];
+#if FF_FS_REENTRANT
+        BITMAP_PRIMITIVE shardBitmap;
+        UINT seq;
+        do
+        {
+            seq = shard_read_begin(shard);
+            shardBitmap = cache_shard_bitmap(cache, shard, drv, sector, count);
+        } while (shard_read_retry(shard, seq));
+        bitmap |= shardBitmap;
+#else
+        bitmap |= cache_shard_bitmap(cache, shard, drv, sector, count);
+#endif
+    }
+    return bitmap;
+}
+#endif
@@ -46,6 +46,27 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 #define SLIM_CACHE_SIZE 256
 
+/**
+ * This option defines the number of shards the cache is split into.
+ * 
+ * A sector is always cached in the shard picked by a hash of its drive and 
+ * sector number, and each shard has its own lock and GCLOCK hand, so threads 
+ * accessing different sectors rarely contend. When FF_FS_REENTRANT is enabled, 
+ * cache hits are read without taking any lock.
+ * 
+ * Each shard holds at least SLIM_CACHE_SHARD_MIN sectors, so smaller caches 
+ * are split into fewer shards. 
+ * 
+ * 1 - The cache is a single shard
+ * > 1 - The cache is split into up to SLIM_CACHE_SHARDS shards
+ */
+#if FF_FS_REENTRANT
+#define SLIM_CACHE_SHARDS 8
+#else
+#define SLIM_CACHE_SHARDS 1
+#endif
+#define SLIM_CACHE_SHARD_MIN 16
+
 /**
  * This option defines whether or not to use DMA to store sectors to the cache
  *
@@ -112,9 +133,12 @@ static_assert(SECTORS_PER_CHUNK > SLIM_PREFETCH_AMOUNT, "Not enough scratch spac
 #endif
 
 
-#if SLIM_USE_CACHE && FF_MAX_SS != FF_MIN_SS
-    #error "Cache can only be used for fixed sector size."
-#endif
+/**
+ * Every cache block holds FF_MAX_SS bytes, but only the sector size of the 
+ * cached drive is copied in and out. When FF_MAX_SS is larger than FF_MIN_SS,
+ * the memory used by the cache is SLIM_CACHE_SIZE * FF_MAX_SS bytes regardless
+ * of the sector size of the mounted drives.
+ */
 
 #if SLIM_USE_CACHE
 typedef struct cache_s CACHE;
@@ -142,11 +166,15 @@ CACHE *cache_init(UINT cacheSize);
  * If it is not cached, returns false, and dst is not modified.
  * Otherwise, if the read is successful, returns true.
  * 
+ * When FF_FS_REENTRANT is enabled, the sector is read without locking, and 
+ * dst may have been partially written if the sector was evicted meanwhile.
+ * 
  * Preconditions:
  *  - cache is initialized
  *  - dst is not necessarily word aligned.
  * Postconditions: 
- *  - If the sector exists, FF_MAX_SS bytes will be written to dst.
+ *  - If the sector exists, as many bytes as the sector size it was stored with 
+ *    will be written to dst.
  */
 BOOL cache_load_sector(CACHE *cache, BYTE drv, LBA_t sector, BYTE *dst);
 
@@ -159,13 +187,14 @@ BOOL cache_load_sector(CACHE *cache, BYTE drv, LBA_t sector, BYTE *dst);
  * use a higher weight.
  * 
  * Preconditions:
- *  - src is readable for exactly FF_MAX_SS bytes
+ *  - src is readable for exactly ssize bytes
  *    if this is not the case, bad things will happen.
+ *  - ssize is the sector size of the drive, and at most FF_MAX_SS.
  *
  *  - if SLIM_DMA_CACHE_STORE is defined (default), src is cache (32-byte)-aligned
  *    and in EWRAM (DMA readable)
  */ 
-void cache_store_sector(CACHE *cache, BYTE drv, LBA_t sector, const BYTE *src, BYTE weight);
+void cache_store_sector(CACHE *cache, BYTE drv, LBA_t sector, const BYTE *src, UINT ssize, BYTE weight);
 
 /**
  * Invalidates the specified sector 
@@ -187,5 +216,54 @@ BOOL cache_invalidate_sector(CACHE *cache, BYTE drv, LBA_t sector);
  * the alloted count.
  */ 
 BITMAP_PRIMITIVE cache_get_existence_bitmap(CACHE *cache, BYTE drv, LBA_t sector, BYTE count);
+
+/**
+ * Updates the cache after the specified sector of ssize bytes was written to the disk from src.
+ * 
+ * Unpinned copies of the sector are invalidated, and pinned copies are overwritten
+ * with src so that every file buffer referring to the sector stays coherent. If src
+ * is itself a block reserved with cache_reserve_sector, it becomes valid.
+ */
+void cache_write_sector(CACHE *cache, BYTE drv, LBA_t sector, const BYTE *src, UINT ssize);
+
+/**
+ * Pins the cached block of the specified sector, and returns a pointer to its
+ * FF_MAX_SS bytes of data.
+ * 
+ * If the sector is not cached, returns NULL. Pinned blocks are never evicted,
+ * and can be modified in place until they are unpinned with cache_unpin_sector.
+ */
+BYTE *cache_pin_sector(CACHE *cache, BYTE drv, LBA_t sector);
+
+/**
+ * Reserves and pins a block for the specified sector of ssize bytes without loading it.
+ * 
+ * The block is not visible to lookups until it is written to the disk with
+ * disk_write. Returns NULL if every block is pinned.
+ */
+BYTE *cache_reserve_sector(CACHE *cache, BYTE drv, LBA_t sector, UINT ssize);
+
+/**
+ * Unpins a block previously returned by cache_pin_sector or cache_reserve_sector.
+ * 
+ * Returns false if data is not the data of a cache block.
+ */
+BOOL cache_unpin_sector(CACHE *cache, const BYTE *data);
+
+/**
+ * Invalidates every cached sector between start and end inclusive, after they were discarded.
+ * 
+ * Pinned blocks are kept, since the file buffers referring to them still own their data.
+ */
+void cache_discard_sectors(CACHE *cache, BYTE drv, LBA_t start, LBA_t end);
+
+/**
+ * Copies size bytes from src to dst with the ARM block transfer instructions.
+ * 
+ * Preconditions:
+ *  - src and dst are word aligned.
+ *  - size is a multiple of 64 bytes, and not 0.
+ */
+void cache_cpy(const void *src, const void *dst, UINT size);
 #endif
 #endif
\ No newline at end of file
@@ -30,9 +30,10 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 
 /*
- * Copies 512 bytes from aligned src to aligned dst
+ * Copies size bytes from aligned src to aligned dst.
+ * size must be a non-zero multiple of 64 bytes.
  */
-@void cachecpy (const void *src, const void *dst);
+@void cache_cpy (const void *src, const void *dst, UINT size);
 .section .text
 .align 4
 .global cache_cpy
@@ -40,58 +41,21 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 .arm
 
 cache_cpy:
-    push {r0-r9}    // Save registers
+    push {r4-r10}   // Save registers
 
     mov r8, r0      // Save src in r8
     mov r9, r1      // Save dst in r9
+    mov r10, r2     // Save size in r10
 
+1:
     ldmia r8!, {r0-r7} // 8 words = 32 bytes
     stmia r9!, {r0-r7} 
 
     ldmia r8!, {r0-r7} // 16 words = 64 bytes
     stmia r9!, {r0-r7} 
 
-    ldmia r8!, {r0-r7} // 24 words = 96 bytes
-    stmia r9!, {r0-r7} 
-
-    ldmia r8!, {r0-r7} // 32 words = 128 bytes
-    stmia r9!, {r0-r7} 
-
-    ldmia r8!, {r0-r7} // 40 words = 160 bytes
-    stmia r9!, {r0-r7} 
-
-    ldmia r8!, {r0-r7} // 48 words = 192 bytes
-    stmia r9!, {r0-r7} 
-
-    ldmia r8!, {r0-r7} // 56 words = 96 bytes
-    stmia r9!, {r0-r7} 
-
-    ldmia r8!, {r0-r7} // 64 words = 256 bytes
-    stmia r9!, {r0-r7} 
-
-    ldmia r8!, {r0-r7} // 72 words = 288 bytes
-    stmia r9!, {r0-r7} 
-
-    ldmia r8!, {r0-r7} // 80 words = 320 bytes
-    stmia r9!, {r0-r7} 
-
-    ldmia r8!, {r0-r7} // 88 words = 352 bytes
-    stmia r9!, {r0-r7} 
-
-    ldmia r8!, {r0-r7} // 96 words = 384 bytes
-    stmia r9!, {r0-r7} 
-
-    ldmia r8!, {r0-r7} // 104 words = 416 bytes
-    stmia r9!, {r0-r7} 
-
-    ldmia r8!, {r0-r7} // 112 words = 448 bytes
-    stmia r9!, {r0-r7} 
-
-    ldmia r8!, {r0-r7} // 120 words = 480 bytes
-    stmia r9!, {r0-r7} 
-
-    ldmia r8!, {r0-r7} // 128 words = 512 bytes
-    stmia r9!, {r0-r7} 
+    subs r10, r10, #64
+    bhi 1b
 
-    pop	{r0-r9}     // Restore registers
+    pop	{r4-r10}    // Restore registers
 	  bx	lr          // Return
@@ -26,75 +26,226 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 
 #include <ff.h>
+#include "charset.h"
+#include "ffvolumes.h"
 
-#include <stdlib.h>
+#include <stdint.h>
 
-#include <wchar.h>
-#include <stdlib.h>
-#include <wctype.h>
+// With FF_LFN_UNICODE 2, FatFs takes UTF-8 paths and nothing needs to be converted.
+#if FF_LFN_UNICODE != 2
 
-static TCHAR CvtBuf[FF_MAX_LFN + 1] __attribute__((aligned(4)));
+// Word loads of the byte and TCHAR strings
+typedef uint32_t __attribute__((may_alias)) CVT_WORD;
 
-TCHAR *mbstoucs2(const char *src, size_t *len)
+// True if none of the 4 bytes of w is 0 or above 0x7F.
+// A zero byte borrows from the bytes above it only after it was flagged itself.
+#define ASCII_WORD(w) (!((((w) - 0x01010101) | (w)) & 0x80808080))
+
+// True if none of the 2 UTF-16 code units of w is 0 or above 0x7F.
+#define ASCII_UNITS(w) (!((((w) - 0x00010001) | (w)) & 0xFF80FF80))
+
+TCHAR *mbstoucs2(TCHAR *buf, const char *src, size_t *len)
 {
-    mbstate_t ps = {0};
-    wchar_t tempChar;
-    int bytes;
-    TCHAR *dst = CvtBuf;
-    while (src)
+    const BYTE *s = (const BYTE *)src;
+    TCHAR *dst = buf;
+    TCHAR *end = &buf[FF_MAX_LFN];
+
+    while (s)
     {
-        bytes = mbrtowc(&tempChar, src, MB_CUR_MAX, &ps);
-        if (bytes > 0)
+        // Convert runs of ASCII characters 4 at a time. Aligned word loads
+        // never cross into another page, even past the terminator.
+        if (!((uintptr_t)s & 0x3))
         {
-            *dst = (TCHAR)tempChar;
-            src += bytes;
-            dst++;
+            while (end - dst >= 4 && ASCII_WORD(*(const CVT_WORD *)s))
+            {
+                dst[0] = s[0];
+                dst[1] = s[1];
+                dst[2] = s[2];
+                dst[3] = s[3];
+                dst += 4;
+                s += 4;
+            }
         }
-        else if (bytes == 0)
-        {
+
+        DWORD c = *s++;
+        if (c == 0)
             break;
-        }
-        else
+
+        if (c >= 0x80)
         {
-            dst = CvtBuf;
-            break;
+            // Multi-byte sequence: find its length and the smallest code point it may encode.
+            UINT n;
+            DWORD min;
+            if ((c & 0xE0) == 0xC0)
+            {
+                n = 1;
+                min = 0x80;
+                c &= 0x1F;
+            }
+            else if ((c & 0xF0) == 0xE0)
+            {
+                n = 2;
+                min = 0x800;
+                c &= 0x0F;
+            }
+            else if ((c & 0xF8) == 0xF0)
+            {
+                n = 3;
+                min = 0x10000;
+                c &= 0x07;
+            }
+            else
+            {
+                goto invalid;
+            }
+
+            while (n--)
+            {
+                if ((*s & 0xC0) != 0x80)
+                    goto invalid;
+                c = (c << 6) | (*s++ & 0x3F);
+            }
+
+            // Reject overlong forms, surrogates and code points past U+10FFFF
+            if (c < min || (c >= 0xD800 && c <= 0xDFFF) || c > 0x10FFFF)
+                goto invalid;
+
+            if (c >= 0x10000)
+            {
+                // Encode as a surrogate pair
+                if (end - dst < 2)
+                    goto invalid;
+                c -= 0x10000;
+                *dst++ = (TCHAR)(0xD800 | (c >> 10));
+                c = 0xDC00 | (c & 0x3FF);
+            }
         }
+
+        if (dst == end)
+            goto invalid;
+        *dst++ = (TCHAR)c;
     }
+
     *dst = '\0';
     if (len)
-        *len = dst - CvtBuf;
-    return CvtBuf;
+        *len = dst - buf;
+    return buf;
+
+invalid:
+    buf[0] = '\0';
+    if (len)
+        *len = 0;
+    return buf;
 }
 
-size_t ucs2tombs(char *dst, const TCHAR *src)
+const TCHAR *path_to_tchar(TCHAR *buf, const char *src, size_t *len)
 {
-    mbstate_t ps = {0};
-    size_t count = 0;
-    int bytes;
-    char buff[MB_CUR_MAX + 1];
-    int i;
+    const char *rest;
+    volno_t vol = get_vol_prefix(src, &rest);
+    if (vol == -1)
+        return mbstoucs2(buf, src, len);
 
-    while (*src != '\0')
+    const TCHAR *root = get_vol_root(vol);
+    size_t restLen;
+    buf[0] = root[0];
+    buf[1] = root[1];
+    mbstoucs2(&buf[2], rest, &restLen);
+    if (restLen == 0 && rest[0])
     {
-        bytes = wcrtomb(buff, *src, &ps);
-        if (bytes < 0)
-        {
-            return -1;
-        }
-        if (bytes > 0)
+        // The rest of the path is invalid, so the output must not be the root
+        buf[0] = '\0';
+        if (len)
+            *len = 0;
+        return buf;
+    }
+    if (len)
+        *len = restLen + 2;
+    return buf;
+}
+
+size_t ucs2tombsn(char *dst, const TCHAR *src, size_t size)
+{
+    if (size == 0)
+        return CVT_TOOLONG;
+
+    char *start = dst;
+    // Leave room for the terminator
+    size_t room = size - 1;
+
+    while (true)
+    {
+        // Convert runs of ASCII characters 4 at a time.
+        if (!((uintptr_t)src & 0x3))
         {
-            for (i = 0; i < bytes; i++)
+            while (room >= 4)
             {
-                *dst++ = buff[i];
+                // Test the low word first, so that the word after a terminator
+                // in it is never loaded.
+                if (!ASCII_UNITS(((const CVT_WORD *)src)[0]) || !ASCII_UNITS(((const CVT_WORD *)src)[1]))
+                    break;
+                dst[0] = (char)src[0];
+                dst[1] = (char)src[1];
+                dst[2] = (char)src[2];
+                dst[3] = (char)src[3];
+                dst += 4;
+                src += 4;
+                room -= 4;
             }
-            src++;
-            count += bytes;
+        }
+
+        DWORD c = *src++;
+        if (c == 0)
+            break;
+
+        if (c >= 0xD800 && c <= 0xDFFF)
+        {
+            // Only a high surrogate followed by a low surrogate is valid
+            if (c >= 0xDC00 || *src < 0xDC00 || *src > 0xDFFF)
+                return CVT_INVALID;
+            c = 0x10000 + ((c & 0x3FF) << 10) + (*src++ & 0x3FF);
+        }
+
+        if (c < 0x80)
+        {
+            if (room < 1)
+                return CVT_TOOLONG;
+            room -= 1;
+            *dst++ = (char)c;
+        }
+        else if (c < 0x800)
+        {
+            if (room < 2)
+                return CVT_TOOLONG;
+            room -= 2;
+            *dst++ = (char)(0xC0 | (c >> 6));
+            *dst++ = (char)(0x80 | (c & 0x3F));
+        }
+        else if (c < 0x10000)
+        {
+            if (room < 3)
+                return CVT_TOOLONG;
+            room -= 3;
+            *dst++ = (char)(0xE0 | (c >> 12));
+            *dst++ = (char)(0x80 | ((c >> 6) & 0x3F));
+            *dst++ = (char)(0x80 | (c & 0x3F));
         }
         else
         {
-            break;
+            if (room < 4)
+                return CVT_TOOLONG;
+            room -= 4;
+            *dst++ = (char)(0xF0 | (c >> 18));
+            *dst++ = (char)(0x80 | ((c >> 12) & 0x3F));
+            *dst++ = (char)(0x80 | ((c >> 6) & 0x3F));
+            *dst++ = (char)(0x80 | (c & 0x3F));
         }
     }
-    *dst = L'\0';
-    return count;
+    *dst = '\0';
+    return dst - start;
+}
+
+size_t ucs2tombs(char *dst, const TCHAR *src)
+{
+    return ucs2tombsn(dst, src, SIZE_MAX);
 }
+#endif
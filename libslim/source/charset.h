@@ -30,15 +30,76 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "ff.h"
 
-// Converts from TCHAR to char
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// Returned by ucs2tombs and ucs2tombsn if the string has an unpaired surrogate.
+#define CVT_INVALID ((size_t)-1)
+
+// Returned by ucs2tombsn if the converted string does not fit.
+#define CVT_TOOLONG ((size_t)-2)
+
+#if FF_LFN_UNICODE == 2
+// FatFs takes and returns UTF-8 names, so they are used without conversion.
+
+// Size in TCHARs of a buffer for path_to_tchar. Paths are not copied into it.
+#define PATH_BUF_SIZE 1
+
+// Gets the TCHAR path of src, and stores its length into len.
+static inline const TCHAR *path_to_tchar(TCHAR *buf, const char *src, size_t *len)
+{
+    (void)buf;
+    if (len)
+        *len = strlen(src);
+    return src;
+}
+
+// Copies a TCHAR name to dst, writing at most size bytes including the terminator.
+//
+// returns the length of the name, or CVT_TOOLONG if it does not fit in size bytes.
+static inline size_t tchar_to_mbsn(char *dst, const TCHAR *src, size_t size)
+{
+    size_t len = strlen(src);
+    if (len >= size)
+        return CVT_TOOLONG;
+    memcpy(dst, src, len + 1);
+    return len;
+}
+#else
+// Converts from TCHAR to UTF-8 char
 // returns the length of the converted string
 size_t ucs2tombs(char *dst, const TCHAR *src);
 
-// Converts from char to TCHAR
+// Converts from TCHAR to UTF-8 char, writing at most size bytes
+// including the terminator.
 //
-// returns a pointer to the buffer containing
-// the utf16 output.
+// returns the length of the converted string, or CVT_TOOLONG
+// if it does not fit in size bytes.
+size_t ucs2tombsn(char *dst, const TCHAR *src, size_t size);
+
+// Size in TCHARs of a buffer for mbstoucs2 and path_to_tchar, with room
+// for the volume root path_to_tchar puts in place of a volume name.
+#define PATH_BUF_SIZE (FF_MAX_LFN + 3)
+
+// Converts from UTF-8 char to TCHAR into buf, which must hold
+// PATH_BUF_SIZE TCHARs.
+//
+// returns buf.
 // 
 // stores the length of the converted string into len.
-TCHAR *mbstoucs2(const char *src, size_t *len);
+// If src is not valid UTF-8, or is longer than FF_MAX_LFN
+// UTF-16 code units, the output is empty.
+TCHAR *mbstoucs2(TCHAR *buf, const char *src, size_t *len);
+
+// Gets the TCHAR path of src in buf, which must hold PATH_BUF_SIZE TCHARs,
+// and stores its length into len.
+//
+// A volume prefix such as "sd:" is resolved on src and replaced with the
+// root of the volume such as "1:", so FatFs does not compare volume names.
+const TCHAR *path_to_tchar(TCHAR *buf, const char *src, size_t *len);
+#define tchar_to_mbsn(dst, src, size) ucs2tombsn((dst), (src), (size))
+#endif
+
+#define tchar_to_mbs(dst, src) tchar_to_mbsn((dst), (src), SIZE_MAX)
 #endif
\ No newline at end of file
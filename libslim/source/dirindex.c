@@ -0,0 +1,353 @@
+/*
+Copyright (c) 2020, chyyran
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the copyright holder nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL CHYYRAN BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "dirindex.h"
+#include "memcopy.h"
+#include "lock.h"
+
+#if FF_USE_DIR_INDEX
+
+// Number of entries a new index starts out with. Must be a power of 2.
+#define DIRINDEX_INITIAL_SIZE 64
+
+#define SLOT_EMPTY 0
+#define SLOT_DELETED 0xFFFF
+
+typedef struct dirindex_entry_s
+{
+    WORD hash;
+    // Entry index + 1 of the entry block, or SLOT_EMPTY/SLOT_DELETED.
+    WORD slot;
+} DIRINDEX_ENTRY;
+
+typedef struct dirindex_s
+{
+    FATFS *fs;
+    // Mount ID of fs when the index was built.
+    WORD id;
+    DWORD sclust;
+    // Value of _useCounter on last access, for LRU eviction
+    DWORD lastUse;
+    // Number of live names
+    UINT count;
+    // Number of live and deleted slots
+    UINT used;
+    // Number of slots in the table - 1
+    UINT mask;
+    // NULL if this index is unused.
+    DIRINDEX_ENTRY *table;
+} DIRINDEX;
+
+typedef struct dirindex_excluded_s
+{
+    FATFS *fs;
+    WORD id;
+    DWORD sclust;
+} DIRINDEX_EXCLUDED;
+
+static DIRINDEX _index[FF_DIR_INDEX_DIRS];
+static UINT _indexBytes = 0;
+static DWORD _useCounter = 0;
+// Directories too large to be indexed, replaced round robin
+static DIRINDEX_EXCLUDED _excluded[FF_DIR_INDEX_DIRS];
+static UINT _excludedNext = 0;
+// Guards the slots and the memory budget, which are shared between volumes.
+// The table of an index is only used under the FatFs lock of its volume.
+static SLIM_LOCK _lock = SLIM_LOCK_INIT;
+
+static inline UINT table_bytes(UINT size)
+{
+    return size * sizeof(DIRINDEX_ENTRY);
+}
+
+static void dirindex_free(DIRINDEX *idx)
+{
+    if (!idx->table)
+        return;
+    _indexBytes -= table_bytes(idx->mask + 1);
+    ff_memfree(idx->table);
+    idx->table = NULL;
+    idx->fs = NULL;
+}
+
+static inline BOOL dirindex_stale(DIRINDEX *idx)
+{
+    return !idx->fs->fs_type || idx->fs->id != idx->id;
+}
+
+// Evicts the least recently used index other than keep.
+// When FatFs is reentrant, only indexes of fs are evicted, since
+// another thread may be using the indexes of other volumes.
+// Returns false if there was nothing left to evict.
+static BOOL dirindex_evict(FATFS *fs, DIRINDEX *keep)
+{
+    DIRINDEX *victim = NULL;
+    for (int i = 0; i < FF_DIR_INDEX_DIRS; i++)
+    {
+        DIRINDEX *idx = &_index[i];
+        if (!idx->table || idx == keep)
+            continue;
+#if FF_FS_REENTRANT
+        if (idx->fs != fs)
+            continue;
+#endif
+        if (dirindex_stale(idx))
+        {
+            victim = idx;
+            break;
+        }
+        if (!victim || (DWORD)(_useCounter - idx->lastUse) > (DWORD)(_useCounter - victim->lastUse))
+            victim = idx;
+    }
+    if (!victim)
+        return false;
+    dirindex_free(victim);
+    return true;
+}
+
+// Replaces the table of idx with an empty table of the given size,
+// evicting other indexes to stay within FF_DIR_INDEX_BUDGET.
+static DIRINDEX_ENTRY *dirindex_alloc_table(FATFS *fs, DIRINDEX *idx, UINT size)
+{
+    UINT oldBytes = idx->table ? table_bytes(idx->mask + 1) : 0;
+    if (table_bytes(size) > FF_DIR_INDEX_BUDGET)
+        return NULL;
+    while (_indexBytes - oldBytes + table_bytes(size) > FF_DIR_INDEX_BUDGET)
+    {
+        if (!dirindex_evict(fs, idx))
+            return NULL;
+    }
+    DIRINDEX_ENTRY *table = ff_memalloc(table_bytes(size));
+    if (table)
+    {
+        MEMCLR(table, table_bytes(size));
+        _indexBytes += table_bytes(size);
+    }
+    return table;
+}
+
+static void dirindex_put(DIRINDEX_ENTRY *table, UINT mask, WORD hash, WORD slot)
+{
+    UINT i = hash & mask;
+    while (table[i].slot != SLOT_EMPTY && table[i].slot != SLOT_DELETED)
+        i = (i + 1) & mask;
+    table[i].hash = hash;
+    table[i].slot = slot;
+}
+
+DIRINDEX *dirindex_get(FATFS *fs, DWORD sclust)
+{
+    DIRINDEX *found = NULL;
+    slim_lock(&_lock);
+    for (int i = 0; i < FF_DIR_INDEX_DIRS; i++)
+    {
+        DIRINDEX *idx = &_index[i];
+        if (idx->table && idx->fs == fs && idx->sclust == sclust)
+        {
+            if (dirindex_stale(idx))
+            {
+                dirindex_free(idx);
+                break;
+            }
+            idx->lastUse = ++_useCounter;
+            found = idx;
+            break;
+        }
+    }
+    slim_unlock(&_lock);
+    return found;
+}
+
+DIRINDEX *dirindex_create(FATFS *fs, DWORD sclust, UINT count)
+{
+    dirindex_drop(fs, sclust);
+
+    // Size the table for every name up front, so that it never grows while
+    // the directory is read, and nothing is evicted for a table that can not fit.
+    UINT size = DIRINDEX_INITIAL_SIZE;
+    while (count * 4 > size * 3)
+    {
+        size *= 2;
+        if (table_bytes(size) > FF_DIR_INDEX_BUDGET)
+        {
+            dirindex_exclude(fs, sclust);
+            return NULL;
+        }
+    }
+
+    slim_lock(&_lock);
+    DIRINDEX *idx = NULL;
+    do
+    {
+        for (int i = 0; i < FF_DIR_INDEX_DIRS && !idx; i++)
+        {
+            if (!_index[i].table)
+                idx = &_index[i];
+        }
+    } while (!idx && dirindex_evict(fs, NULL));
+
+    DIRINDEX_ENTRY *table = idx ? dirindex_alloc_table(fs, idx, size) : NULL;
+    if (table)
+    {
+        idx->table = table;
+        idx->fs = fs;
+        idx->id = fs->id;
+        idx->sclust = sclust;
+        idx->lastUse = ++_useCounter;
+        idx->count = 0;
+        idx->used = 0;
+        idx->mask = size - 1;
+    }
+    slim_unlock(&_lock);
+    return table ? idx : NULL;
+}
+
+void dirindex_exclude(FATFS *fs, DWORD sclust)
+{
+    slim_lock(&_lock);
+    DIRINDEX_EXCLUDED *ex = &_excluded[_excludedNext];
+    _excludedNext = (_excludedNext + 1) % FF_DIR_INDEX_DIRS;
+    ex->fs = fs;
+    ex->id = fs->id;
+    ex->sclust = sclust;
+    slim_unlock(&_lock);
+}
+
+BOOL dirindex_excluded(FATFS *fs, DWORD sclust)
+{
+    BOOL found = false;
+    slim_lock(&_lock);
+    for (int i = 0; i < FF_DIR_INDEX_DIRS && !found; i++)
+    {
+        DIRINDEX_EXCLUDED *ex = &_excluded[i];
+        found = ex->fs == fs && ex->id == fs->id && ex->sclust == sclust;
+    }
+    slim_unlock(&_lock);
+    return found;
+}
+
+BOOL dirindex_insert(DIRINDEX *idx, WORD hash, DWORD ofs)
+{
+    if (ofs > DIRINDEX_MAX_OFS)
+    {
+        slim_lock(&_lock);
+        dirindex_free(idx);
+        slim_unlock(&_lock);
+        return false;
+    }
+
+    // Keep the load factor under 3/4, counting deleted slots.
+    if ((idx->used + 1) * 4 > (idx->mask + 1) * 3)
+    {
+        UINT size = idx->mask + 1;
+        if ((idx->count + 1) * 2 > size)
+            size *= 2;
+
+        slim_lock(&_lock);
+        DIRINDEX_ENTRY *table = dirindex_alloc_table(idx->fs, idx, size);
+        if (!table)
+        {
+            dirindex_free(idx);
+            slim_unlock(&_lock);
+            return false;
+        }
+
+        for (UINT i = 0; i <= idx->mask; i++)
+        {
+            if (idx->table[i].slot != SLOT_EMPTY && idx->table[i].slot != SLOT_DELETED)
+                dirindex_put(table, size - 1, idx->table[i].hash, idx->table[i].slot);
+        }
+        _indexBytes -= table_bytes(idx->mask + 1);
+        ff_memfree(idx->table);
+        idx->table = table;
+        idx->mask = size - 1;
+        idx->used = idx->count;
+        slim_unlock(&_lock);
+    }
+
+    dirindex_put(idx->table, idx->mask, hash, (WORD)(ofs + 1));
+    idx->count++;
+    idx->used++;
+    return true;
+}
+
+void dirindex_remove(DIRINDEX *idx, DWORD ofs)
+{
+    if (ofs > DIRINDEX_MAX_OFS)
+        return;
+    for (UINT i = 0; i <= idx->mask; i++)
+    {
+        if (idx->table[i].slot == ofs + 1)
+        {
+            idx->table[i].slot = SLOT_DELETED;
+            idx->count--;
+        }
+    }
+}
+
+DWORD dirindex_find(DIRINDEX *idx, WORD hash, UINT *iter)
+{
+    // The iterator counts probes from the home slot.
+    while (*iter <= idx->mask)
+    {
+        DIRINDEX_ENTRY *e = &idx->table[(hash + *iter) & idx->mask];
+        (*iter)++;
+        if (e->slot == SLOT_EMPTY)
+            break;
+        if (e->slot != SLOT_DELETED && e->hash == hash)
+            return e->slot - 1;
+    }
+    *iter = idx->mask + 1;
+    return DIRINDEX_NONE;
+}
+
+void dirindex_drop(FATFS *fs, DWORD sclust)
+{
+    slim_lock(&_lock);
+    for (int i = 0; i < FF_DIR_INDEX_DIRS; i++)
+    {
+        if (_index[i].table && _index[i].fs == fs && _index[i].sclust == sclust)
+            dirindex_free(&_index[i]);
+        if (_excluded[i].fs == fs && _excluded[i].sclust == sclust)
+            _excluded[i].fs = NULL;
+    }
+    slim_unlock(&_lock);
+}
+
+void dirindex_drop_volume(FATFS *fs)
+{
+    slim_lock(&_lock);
+    for (int i = 0; i < FF_DIR_INDEX_DIRS; i++)
+    {
+        if (_index[i].table && _index[i].fs == fs)
+            dirindex_free(&_index[i]);
+        if (_excluded[i].fs == fs)
+            _excluded[i].fs = NULL;
+    }
+    slim_unlock(&_lock);
+}
+#endif
@@ -0,0 +1,120 @@
+/*
+Copyright (c) 2020, chyyran
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the copyright holder nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL CHYYRAN BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef __SLIM_DIRINDEX_H__
+#define __SLIM_DIRINDEX_H__
+
+#include "ff.h"
+
+#if FF_USE_DIR_INDEX
+
+/**
+ * Returned by dirindex_find when there are no more candidate entries.
+ */
+#define DIRINDEX_NONE 0xFFFFFFFF
+
+/**
+ * Largest directory entry index that can be stored in an index.
+ * Directories with entries past this index are never indexed.
+ */
+#define DIRINDEX_MAX_OFS 0xFFFD
+
+typedef struct dirindex_s DIRINDEX;
+
+/**
+ * Gets the name index of the directory starting at sclust on the
+ * specified volume, or NULL if the directory has not been indexed.
+ *
+ * Indexes of a previous mount of the same FATFS object are never returned.
+ */
+DIRINDEX *dirindex_get(FATFS *fs, DWORD sclust);
+
+/**
+ * Creates an empty name index for the directory starting at sclust, with
+ * room for count names, replacing any existing one.
+ *
+ * If an index for count names can not fit within FF_DIR_INDEX_BUDGET even
+ * on its own, nothing is evicted and the directory is excluded. Otherwise,
+ * the least recently used indexes are evicted to make room. When FatFs is
+ * reentrant, only indexes of the same volume are evicted.
+ * Returns NULL if the index could not be allocated.
+ */
+DIRINDEX *dirindex_create(FATFS *fs, DWORD sclust, UINT count);
+
+/**
+ * Remembers that the directory starting at sclust can not be indexed,
+ * so that it is not read again to build an index on every lookup.
+ *
+ * Only the last FF_DIR_INDEX_DIRS excluded directories are remembered.
+ */
+void dirindex_exclude(FATFS *fs, DWORD sclust);
+
+/**
+ * Checks whether the directory starting at sclust was excluded during
+ * the current mount of the volume.
+ */
+BOOL dirindex_excluded(FATFS *fs, DWORD sclust);
+
+/**
+ * Records that the directory entry block starting at entry index ofs
+ * has a name with the given folded hash.
+ *
+ * If the index can not grow within FF_DIR_INDEX_BUDGET, or ofs is
+ * larger than DIRINDEX_MAX_OFS, the index is dropped and false is returned.
+ * The DIRINDEX pointer must not be used again in that case.
+ */
+BOOL dirindex_insert(DIRINDEX *idx, WORD hash, DWORD ofs);
+
+/**
+ * Removes every name recorded for the entry block starting at entry index ofs.
+ */
+void dirindex_remove(DIRINDEX *idx, DWORD ofs);
+
+/**
+ * Iterates the entry blocks that may have a name with the given hash.
+ *
+ * iter must be set to 0 before the first call. Returns the entry index
+ * of the next candidate, or DIRINDEX_NONE once there are no more candidates.
+ * Candidates are not guaranteed to match, and must be verified against the
+ * directory entries themselves.
+ */
+DWORD dirindex_find(DIRINDEX *idx, WORD hash, UINT *iter);
+
+/**
+ * Drops the name index of the directory starting at sclust, if any,
+ * and forgets that it was excluded.
+ */
+void dirindex_drop(FATFS *fs, DWORD sclust);
+
+/**
+ * Drops every name index of the specified volume, and forgets its
+ * excluded directories.
+ */
+void dirindex_drop_volume(FATFS *fs);
+
+#endif
+#endif
@@ -106,13 +106,29 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 	PRINTF_BYTE_TO_BINARY_INT32((i) >> 32), PRINTF_BYTE_TO_BINARY_INT32(i)
 #endif
 
+// Sector size of the drive. Fixed when FatFs is configured for a single sector size.
+#if FF_MAX_SS == FF_MIN_SS
+#define DISK_SS(drv) ((UINT)FF_MAX_SS)
+#else
+#define DISK_SS(drv) ((UINT)get_disc_ssize(drv))
+#endif
+
 #if SLIM_USE_CACHE
 static CACHE *__cache;
 #endif
+// Volumes are locked separately when FatFs is reentrant, so each drive
+// needs its own working buffer.
+#if FF_FS_REENTRANT
+#define WORKING_BUFS FF_VOLUMES
+#define WORKING_BUF(drv) working_bufs[drv]
+#else
+#define WORKING_BUFS 1
+#define WORKING_BUF(drv) working_bufs[0]
+#endif
 #if SLIM_USE_CACHE == 1
-static BYTE *working_buf;
+static BYTE *working_bufs[WORKING_BUFS];
 #elif SLIM_USE_CACHE == 2
-static BYTE working_buf[FF_MAX_SS * SECTORS_PER_CHUNK] __attribute__((aligned(4)));
+static BYTE working_bufs[WORKING_BUFS][FF_MAX_SS * SECTORS_PER_CHUNK] __attribute__((aligned(4)));
 #endif
 /*-----------------------------------------------------------------------*/
 /* Initialize a Drive                                                    */
@@ -128,9 +144,9 @@ DSTATUS disk_initialize(BYTE drv)
 #endif
 
 #if SLIM_USE_CACHE == 1
-	if (!working_buf)
+	if (!WORKING_BUF(drv))
 	{
-		working_buf = ff_memalloc(sizeof(BYTE) * FF_MAX_SS * SECTORS_PER_CHUNK);
+		WORKING_BUF(drv) = ff_memalloc(sizeof(BYTE) * FF_MAX_SS * SECTORS_PER_CHUNK);
 	}
 #endif
 
@@ -164,15 +180,28 @@ static inline DRESULT disk_read_internal(
 	BYTE drv,	  /* Physical drive nmuber (0..) */
 	BYTE *buff,	  /* Data buffer to store read data */
 	LBA_t sector, /* Sector address (LBA) */
-	BYTE count	  /* Number of sectors to read (1..255) */
+	UINT count	  /* Number of sectors to read */
 )
 {
 	const DISC_INTERFACE *disc_io = NULL;
 	if ((disc_io = get_disc_io(drv)) != NULL)
 	{
-		DRESULT res = disc_io->readSectors(sector, count, buff) ? RES_OK : RES_ERROR;
-		swiDelay(256);
-		return res;
+		// Split requests larger than the driver accepts
+		UINT max = get_disc_max_sectors(drv);
+		while (count > 0)
+		{
+			UINT n = (max && count > max) ? max : count;
+			BOOL ok = disc_io->readSectors(sector, n, buff);
+			swiDelay(256);
+			if (!ok)
+			{
+				return RES_ERROR;
+			}
+			sector += n;
+			buff += n * DISK_SS(drv);
+			count -= n;
+		}
+		return RES_OK;
 	}
 	return RES_PARERR;
 }
@@ -200,7 +229,7 @@ DRESULT disk_read(
 	BYTE drv,		  /* Physical drive nmuber (0..) */
 	BYTE *buff,		  /* Data buffer to store read data */
 	LBA_t baseSector, /* Sector address (LBA) */
-	BYTE count		  /* Number of sectors to read (1..255) */
+	UINT count		  /* Number of sectors to read */
 )
 {
 	DRESULT res = RES_PARERR;
@@ -210,10 +239,11 @@ DRESULT disk_read(
 #if !SLIM_USE_CACHE
 		return disk_read_internal(drv, buff, baseSector, count);
 #else
+		UINT ss = DISK_SS(drv);
 
 #ifdef DEBUG_NOGBA
 		char buf[256];
-		sprintf(buf, "load: %d sectors from %ld, wbuf: %p, tbuf: %p", count, baseSector, working_buf, buff);
+		sprintf(buf, "load: %d sectors from %ld, wbuf: %p, tbuf: %p", count, baseSector, WORKING_BUF(drv), buff);
 		nocashMessage(buf);
 #endif
 		// If caching is disabled, there's no reason to read each sector individually..,
@@ -222,20 +252,27 @@ DRESULT disk_read(
 			return disk_read_internal(drv, buff, baseSector, count);
 		}
 
+		// Reads larger than the working buffer are file data streamed across clusters, which
+		// is rarely read again. Read it into buff with a single command without caching it.
+		if (count > SECTORS_PER_CHUNK && !(((uint32_t)buff) & 0x3))
+		{
+			return disk_read_internal(drv, buff, baseSector, count);
+		}
+
 #if !SLIM_CHUNKED_READS
-		for (BYTE i = 0; i < count; i++)
+		for (UINT i = 0; i < count; i++)
 		{
-			if (cache_load_sector(__cache, drv, baseSector + i, &buff[i * FF_MAX_SS]))
+			if (cache_load_sector(__cache, drv, baseSector + i, &buff[i * ss]))
 			{
 				res = RES_OK;
 			}
 			else
 			{
 				// Most read requests are single sector anyways.
-				res = disk_read_internal(drv, working_buf, baseSector + i, 1);
+				res = disk_read_internal(drv, WORKING_BUF(drv), baseSector + i, 1);
 				// single sector reads are more likely to be reused
-				cache_store_sector(__cache, drv, baseSector + i, working_buf, count > 1 ? 1 : 2);
-				MEMCOPY(&buff[i * FF_MAX_SS], working_buf, FF_MAX_SS);
+				cache_store_sector(__cache, drv, baseSector + i, WORKING_BUF(drv), ss, count > 1 ? 1 : 2);
+				MEMCOPY(&buff[i * ss], WORKING_BUF(drv), ss);
 			}
 		}
 
@@ -261,7 +298,7 @@ DRESULT disk_read(
 			// This is a single sector read.
 			// Single sector reads are more likely to be reused
 			// so we assign higher weights
-			DRESULT prefetchOk = disk_read_internal(drv, working_buf, baseSector, 1 + SLIM_PREFETCH_AMOUNT);
+			DRESULT prefetchOk = disk_read_internal(drv, WORKING_BUF(drv), baseSector, 1 + SLIM_PREFETCH_AMOUNT);
 
 			if (prefetchOk == RES_OK)
 			{
@@ -270,13 +307,13 @@ DRESULT disk_read(
 				nocashMessage(buf);
 #endif
 				// single sector reads are more likely to be reused
-				cache_store_sector(__cache, drv, baseSector, working_buf, 2);
-				MEMCOPY(buff, working_buf, FF_MAX_SS);
+				cache_store_sector(__cache, drv, baseSector, WORKING_BUF(drv), ss, 2);
+				MEMCOPY(buff, WORKING_BUF(drv), ss);
 
 				for (BYTE i = 1; i <= SLIM_PREFETCH_AMOUNT; i++)
 				{
 					// prefetch sectors, insert into cache with weight 1
-					cache_store_sector(__cache, drv, baseSector + i, &working_buf[FF_MAX_SS * i], 1);
+					cache_store_sector(__cache, drv, baseSector + i, &WORKING_BUF(drv)[ss * i], ss, 1);
 				}
 				return RES_OK;
 			}
@@ -284,9 +321,9 @@ DRESULT disk_read(
 			sprintf(buf, "LU1: s: %ld, n: %d, failed prefetch", baseSector, 1);
 			nocashMessage(buf);
 #endif
-			res = disk_read_internal(drv, working_buf, baseSector, 1);
-			cache_store_sector(__cache, drv, baseSector, working_buf, 2);
-			MEMCOPY(buff, working_buf, FF_MAX_SS);
+			res = disk_read_internal(drv, WORKING_BUF(drv), baseSector, 1);
+			cache_store_sector(__cache, drv, baseSector, WORKING_BUF(drv), ss, 2);
+			MEMCOPY(buff, WORKING_BUF(drv), ss);
 
 			return res;
 		}
@@ -305,7 +342,7 @@ DRESULT disk_read(
 #endif
 			BYTE chunkOffset = 0;
 			while (chunkOffset < sectorsToRead && cache_load_sector(__cache, drv, baseSector + chunkOffset + sectorOffset,
-									 &buff[(chunkOffset + sectorOffset) * FF_MAX_SS]))
+									 &buff[(chunkOffset + sectorOffset) * ss]))
 			{
 
 #ifdef DEBUG_NOGBA
@@ -328,7 +365,7 @@ DRESULT disk_read(
 
 			sprintf(buf, "LU: s: %ld, i: %d, n: %d", baseSector + sectorOffset, chunkOffset, sectorsToRead - chunkOffset);
 			nocashMessage(buf);
-			res = disk_read_internal(drv, working_buf, baseSector + sectorOffset + chunkOffset,
+			res = disk_read_internal(drv, WORKING_BUF(drv), baseSector + sectorOffset + chunkOffset,
 									 sectorsToRead - chunkOffset);
 			if (res != RES_OK)
 			{
@@ -340,12 +377,12 @@ DRESULT disk_read(
 			}
 			sprintf(buf, "LU complete");
 			nocashMessage(buf);
-			MEMCOPY(&buff[(chunkOffset + sectorOffset) * FF_MAX_SS], working_buf, (sectorsToRead - chunkOffset) * FF_MAX_SS);
+			MEMCOPY(&buff[(chunkOffset + sectorOffset) * ss], WORKING_BUF(drv), (sectorsToRead - chunkOffset) * ss);
 
 			// Cache read sectors
 			for (int j = 0; j < (sectorsToRead - chunkOffset); j++)
 			{
-				cache_store_sector(__cache, drv, baseSector + sectorOffset + chunkOffset + j, &working_buf[j * FF_MAX_SS], 1);
+				cache_store_sector(__cache, drv, baseSector + sectorOffset + chunkOffset + j, &WORKING_BUF(drv)[j * ss], ss, 1);
 			}
 
 			sectorOffset += sectorsToRead;
@@ -368,19 +405,32 @@ DRESULT disk_write(
 	BYTE drv,		  /* Physical drive nmuber (0..) */
 	const BYTE *buff, /* Data to be written */
 	LBA_t sector,	  /* Sector address (LBA) */
-	BYTE count		  /* Number of sectors to write (1..255) */
+	UINT count		  /* Number of sectors to write */
 )
 {
 	const DISC_INTERFACE *disc_io = NULL;
 	if ((disc_io = get_disc_io(drv)) != NULL)
 	{
-		DRESULT res = disc_io->writeSectors(sector, count, buff) ? RES_OK : RES_ERROR;
-		swiDelay(256);
+		// Split requests larger than the driver accepts
+		DRESULT res = RES_OK;
+		UINT max = get_disc_max_sectors(drv);
+		for (UINT i = 0; i < count && res == RES_OK;)
+		{
+			UINT n = (max && count - i > max) ? max : count - i;
+			res = disc_io->writeSectors(sector + i, n, &buff[i * DISK_SS(drv)]) ? RES_OK : RES_ERROR;
+			swiDelay(256);
+			i += n;
+		}
 
 #if SLIM_USE_CACHE
-		for (BYTE i = 0; i < count; i++)
+		UINT ss = DISK_SS(drv);
+		for (UINT i = 0; i < count; i++)
 		{
-			cache_invalidate_sector(__cache, drv, sector + i);
+			// The disk may not hold the new data if the write failed
+			if (res == RES_OK)
+				cache_write_sector(__cache, drv, sector + i, &buff[i * ss], ss);
+			else
+				cache_invalidate_sector(__cache, drv, sector + i);
 		}
 #endif
 		return res;
@@ -389,6 +439,138 @@ DRESULT disk_write(
 }
 #endif /* _READONLY */
 
+/*-----------------------------------------------------------------------*/
+/* Pin Sector Buffers                                                    */
+
+BYTE *disk_pin(
+	BYTE drv,	  /* Physical drive nmuber (0..) */
+	LBA_t sector, /* Sector address (LBA) */
+	BYTE load	  /* 1: Load the sector, 0: The sector will be overwritten */
+)
+{
+	BYTE *buff = NULL;
+	if (!VALID_DISK(drv))
+	{
+		return NULL;
+	}
+
+#if SLIM_USE_CACHE
+	UINT ss = DISK_SS(drv);
+	if (__cache)
+	{
+		if ((buff = cache_pin_sector(__cache, drv, sector)) != NULL)
+		{
+			return buff;
+		}
+
+		if (!load)
+		{
+			if ((buff = cache_reserve_sector(__cache, drv, sector, ss)) != NULL)
+			{
+				return buff;
+			}
+		}
+		else
+		{
+			// Load the sector the same way as a single sector read, then pin it in place.
+			BYTE n = 1 + SLIM_PREFETCH_AMOUNT;
+			if (disk_read_internal(drv, WORKING_BUF(drv), sector, n) != RES_OK)
+			{
+				n = 1;
+				if (disk_read_internal(drv, WORKING_BUF(drv), sector, 1) != RES_OK)
+				{
+					return NULL;
+				}
+			}
+			for (BYTE i = 1; i < n; i++)
+			{
+				cache_store_sector(__cache, drv, sector + i, &WORKING_BUF(drv)[ss * i], ss, 1);
+			}
+			cache_store_sector(__cache, drv, sector, WORKING_BUF(drv), ss, 2);
+			if ((buff = cache_pin_sector(__cache, drv, sector)) != NULL)
+			{
+				return buff;
+			}
+
+			// Every block is pinned, fall back to a private buffer.
+			if ((buff = ff_memalloc(FF_MAX_SS)) != NULL)
+			{
+				MEMCOPY(buff, WORKING_BUF(drv), ss);
+			}
+			return buff;
+		}
+	}
+#endif
+
+	buff = ff_memalloc(FF_MAX_SS);
+	if (buff && load && disk_read(drv, buff, sector, 1) != RES_OK)
+	{
+		ff_memfree(buff);
+		buff = NULL;
+	}
+	return buff;
+}
+
+void disk_unpin(
+	BYTE drv,  /* Physical drive nmuber (0..) */
+	BYTE *buff /* Buffer returned by disk_pin */
+)
+{
+#if SLIM_USE_CACHE
+	if (cache_unpin_sector(__cache, buff))
+	{
+		return;
+	}
+#endif
+	ff_memfree(buff);
+}
+
+// Gets the size of the drive in sectors. DISC_INTERFACE can not report it,
+// so this is either the size configured for the volume, or the extent of the
+// partition table or volume boot record already on the drive.
+static DRESULT disk_sector_count(BYTE drv, LBA_t *count)
+{
+	UINT ss = DISK_SS(drv);
+	BYTE *buf;
+	LBA_t end;
+	int i;
+
+	if ((*count = get_disc_sectors(drv)) != 0)
+		return RES_OK;
+	if (!(buf = ff_memalloc(ss)))
+		return RES_ERROR;
+	if (disk_read(drv, buf, 0, 1) != RES_OK || buf[510] != 0x55 || buf[511] != 0xAA)
+	{
+		ff_memfree(buf);
+		return RES_ERROR;
+	}
+	if (!memcmp(buf + 3, "EXFAT   ", 8))
+	{
+		// exFAT VBR: VolumeLength
+		*count = (LBA_t)(buf[72] | buf[73] << 8 | buf[74] << 16 | (DWORD)buf[75] << 24);
+	}
+	else if ((buf[0] == 0xEB || buf[0] == 0xE9) && (buf[11] | buf[12] << 8) == ss)
+	{
+		// FAT VBR: TotSec16, or TotSec32 if it is 0
+		*count = buf[19] | buf[20] << 8;
+		if (!*count)
+			*count = buf[32] | buf[33] << 8 | buf[34] << 16 | (DWORD)buf[35] << 24;
+	}
+	else
+	{
+		// MBR: end of the last partition
+		for (i = 0; i < 4; i++)
+		{
+			BYTE *pte = buf + 446 + i * 16;
+			end = (pte[8] | pte[9] << 8 | pte[10] << 16 | (DWORD)pte[11] << 24) + (pte[12] | pte[13] << 8 | pte[14] << 16 | (DWORD)pte[15] << 24);
+			if (pte[4] && end > *count)
+				*count = end;
+		}
+	}
+	ff_memfree(buf);
+	return *count ? RES_OK : RES_ERROR;
+}
+
 /*-----------------------------------------------------------------------*/
 /* Miscellaneous Functions                                               */
 
@@ -405,6 +587,26 @@ DRESULT disk_ioctl(
 		{
 			return disc_io->clearStatus() ? RES_OK : RES_ERROR;
 		}
+		if (ctrl == GET_SECTOR_SIZE)
+		{
+			*(WORD *)buff = (WORD)DISK_SS(drv);
+			return RES_OK;
+		}
+		if (ctrl == GET_SECTOR_COUNT)
+		{
+			return disk_sector_count(drv, (LBA_t *)buff);
+		}
+		if (ctrl == CTRL_TRIM)
+		{
+			LBA_t *range = (LBA_t *)buff;
+			FN_MEDIUM_DISCARD discard = get_disc_discard(drv);
+#if SLIM_USE_CACHE
+			cache_discard_sectors(__cache, drv, range[0], range[1]);
+#endif
+			if (!discard)
+				return RES_OK;
+			return discard(range[0], range[1] - range[0] + 1) ? RES_OK : RES_ERROR;
+		}
 		return RES_OK;
 	}
 	return RES_PARERR;
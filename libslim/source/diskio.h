@@ -56,9 +56,13 @@ typedef enum {
 
 DSTATUS disk_initialize (BYTE pdrv);
 DSTATUS disk_status (BYTE pdrv);
-DRESULT disk_read (BYTE pdrv, BYTE* buff, LBA_t sector, BYTE count);
-DRESULT disk_write (BYTE pdrv, const BYTE* buff, LBA_t sector, BYTE count);
+DRESULT disk_read (BYTE pdrv, BYTE* buff, LBA_t sector, UINT count);
+DRESULT disk_write (BYTE pdrv, const BYTE* buff, LBA_t sector, UINT count);
 DRESULT disk_ioctl (BYTE pdrv, BYTE cmd, void* buff);
+/* --- BEGIN LIBSLIM PATCH: FEAT_PINNED_BUF --- */
+BYTE* disk_pin (BYTE pdrv, LBA_t sector, BYTE load);
+void disk_unpin (BYTE pdrv, BYTE* buff);
+/* --- END LIBSLIM PATCH: FEAT_PINNED_BUF --- */
 
 
 /* Disk Status Bits (DSTATUS) */
@@ -34,6 +34,7 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <ctype.h>
 #include <string.h>
+#include <limits.h>
 
 #include <wchar.h>
 #include <stdlib.h>
@@ -46,8 +47,7 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "tonccpy.h"
 #include "charset.h"
-
-int elm_error;
+#include "lock.h"
 
 static FATFS _elm[FF_VOLUMES];
 
@@ -61,6 +61,9 @@ static FATFS _elm[FF_VOLUMES];
 
 #define FF_FASTSEEK_TBL_SZ 24
 
+// Largest file size or position an off_t can represent
+#define ELM_OFF_MAX (sizeof(off_t) < sizeof(int64_t) ? (int64_t)LONG_MAX : INT64_MAX)
+
 int _ELM_open_r(struct _reent *r, void *fileStruct, const char *path, int flags, int mode);
 int _ELM_close_r(struct _reent *r, void *fd);
 ssize_t _ELM_write_r(struct _reent *r, void *fd, const char *ptr, size_t len);
@@ -85,10 +88,33 @@ int _ELM_rmdir_r(struct _reent *r, const char *name);
 typedef struct _DIR_EX_
 {
     DIR dir;
-    TCHAR name[FF_MAX_LFN + 1];
-    size_t namesize;
 } DIR_EX;
 
+struct fat_file_s
+{
+    FIL fil;
+    // End of the last positional access and the cluster it was in, where the
+    // cluster chain walk of the next positional access can resume from.
+    FSIZE_t atPtr;
+    DWORD atClust;
+    // Held across each call, so that a positional access, which moves the file
+    // pointer and puts it back, is atomic to the other calls on the handle.
+    SLIM_LOCK lock;
+};
+
+struct fat_dir_s
+{
+    DIR dir;
+    // Entry read by f_readdir that did not fit in the last batch
+    FILINFO pending;
+    bool hasPending;
+    bool filtered;
+    // errno of an error that ended the last batch after some entries were read
+    int error;
+    // Pattern of a filtered directory, referenced by dir.pat
+    TCHAR pattern[];
+};
+
 #define ELM_DEVOPTAB(mount)                     \
     {                                           \
         mount,                                  \
@@ -132,58 +158,53 @@ static const devoptab_t dotab_elm[FF_VOLUMES] =
  */
 #define _ELM_realpath(path) (path)
 
-ssize_t _ELM_errnoparse(struct _reent *r, ssize_t suc, int fail)
+// Gets the errno value of a failed FatFs call.
+static int _ELM_errno(FRESULT res)
 {
-    int ret = fail;
-    switch (elm_error)
+    switch (res)
     {
-    case FR_OK:
-        ret = suc;
-        break;
     case FR_NO_FILE:
-        r->_errno = ENOENT;
-        break;
+        return ENOENT;
     case FR_NO_PATH:
-        r->_errno = ENOENT;
-        break;
+        return ENOENT;
     case FR_INVALID_NAME:
-        r->_errno = EINVAL;
-        break;
+        return EINVAL;
     case FR_INVALID_DRIVE:
-        r->_errno = EINVAL;
-        break;
+        return EINVAL;
     case FR_EXIST:
-        r->_errno = EEXIST;
-        break;
+        return EEXIST;
     case FR_DENIED:
-        r->_errno = EACCES;
-        break;
+        return EACCES;
     case FR_NOT_READY:
-        r->_errno = ENODEV;
-        break;
+        return ENODEV;
     case FR_WRITE_PROTECTED:
-        r->_errno = EROFS;
-        break;
+        return EROFS;
     case FR_DISK_ERR:
-        r->_errno = EIO;
-        break;
+        return EIO;
     case FR_INT_ERR:
-        r->_errno = EIO;
-        break;
+        return EIO;
     case FR_NOT_ENABLED:
-        r->_errno = EINVAL;
-        break;
+        return EINVAL;
     case FR_NO_FILESYSTEM:
-        r->_errno = EIO;
-        break;
+        return EIO;
+    default:
+        return EIO;
     }
-    return ret;
+}
+
+ssize_t _ELM_errnoparse(struct _reent *r, FRESULT res, ssize_t suc, int fail)
+{
+    if (res == FR_OK)
+        return suc;
+    r->_errno = _ELM_errno(res);
+    return fail;
 }
 
 int _ELM_open_r(struct _reent *r, void *fileStruct, const char *path, int flags, int mode)
 {
     FIL *fp = (FIL *)fileStruct;
-    const TCHAR *p = mbstoucs2(_ELM_realpath(path), NULL);
+    TCHAR pathBuf[PATH_BUF_SIZE];
+    const TCHAR *p = path_to_tchar(pathBuf, _ELM_realpath(path), NULL);
 
     BYTE ff_flags = 0;
 
@@ -229,27 +250,35 @@ int _ELM_open_r(struct _reent *r, void *fileStruct, const char *path, int flags,
         ff_flags |= FA_OPEN_APPEND;
     }
 
-    elm_error = f_open(fp, p, ff_flags);
+    FRESULT res = f_open(fp, p, ff_flags);
 
 #if FF_USE_FASTSEEK
-    if (((flags & O_RDONLY) || (flags == O_RDONLY)) && elm_error == FR_OK) // Enable fast seek if read only
+    if (((flags & O_RDONLY) || (flags == O_RDONLY)) && res == FR_OK) // Enable fast seek if read only
     {
         FSIZE_t ptr = f_tell(fp);
 
-        fp->cltbl = ff_memalloc(FF_FASTSEEK_TBL_SZ * sizeof(DWORD));
-        fp->cltbl[0] = FF_FASTSEEK_TBL_SZ;
-        elm_error = f_lseek(fp, CREATE_LINKMAP);
-
-        if (elm_error != FR_OK)
+        fp->cltbl = ff_poolalloc(FF_FASTSEEK_TBL_SZ * sizeof(DWORD));
+        if (fp->cltbl)
         {
-            ff_memfree(fp->cltbl);
-            fp->cltbl = NULL;
+            fp->cltbl[0] = FF_FASTSEEK_TBL_SZ;
+            res = f_lseek(fp, CREATE_LINKMAP);
+
+            if (res != FR_OK)
+            {
+                ff_memfree(fp->cltbl);
+                fp->cltbl = NULL;
+            }
+
+            res = f_lseek(fp, ptr);
+            if (res != FR_OK)
+            {
+                // The FIL is freed on failure, so it must not stay open with a pinned window
+                _ELM_close_r(r, fp);
+            }
         }
-
-        elm_error = f_lseek(fp, ptr);
     }
 #endif
-    return _ELM_errnoparse(r, (int)fp, -1);
+    return _ELM_errnoparse(r, res, (int)fp, -1);
 }
 
 int _ELM_close_r(struct _reent *r, void *fd)
@@ -263,8 +292,13 @@ int _ELM_close_r(struct _reent *r, void *fd)
         fp->cltbl = NULL;
     }
 #endif
-    elm_error = f_close(fp);
-    return _ELM_errnoparse(r, 0, -1);
+    FRESULT res = f_close(fp);
+#if !FF_FS_TINY && FF_PINNED_FILE_BUF
+    // The file is freed even if it could not be closed, so its window must not stay pinned.
+    if (res != FR_OK)
+        f_unpin(fp);
+#endif
+    return _ELM_errnoparse(r, res, 0, -1);
 }
 
 ssize_t _ELM_write_r(struct _reent *r, void *fd, const char *ptr, size_t len)
@@ -278,8 +312,8 @@ ssize_t _ELM_write_r(struct _reent *r, void *fd, const char *ptr, size_t len)
     }
 
     UINT written = 0;
-    elm_error = f_write(fp, ptr, len, &written);
-    return _ELM_errnoparse(r, written, -1);
+    FRESULT res = f_write(fp, ptr, len, &written);
+    return _ELM_errnoparse(r, res, written, -1);
 #else
     r->_errno = ENOSYS;
     return -1;
@@ -290,41 +324,56 @@ ssize_t _ELM_read_r(struct _reent *r, void *fd, char *ptr, size_t len)
 {
     FIL *fp = (FIL *)fd;
     UINT read = 0;
-    elm_error = f_read(fp, ptr, (UINT)len, &read);
-    return _ELM_errnoparse(r, read, -1);
+    FRESULT res = f_read(fp, ptr, (UINT)len, &read);
+    return _ELM_errnoparse(r, res, read, -1);
 }
 
-off_t _ELM_seek_r(struct _reent *r, void *fd, off_t pos, int whence)
-{
 #if FF_FS_MINIMIZE < 3
-    FIL *f = (FIL *)fd;
-    FSIZE_t off;
+// Moves the file pointer to pos relative to whence. Fails with EOVERFLOW
+// without moving it if the new position would be larger than max.
+// Returns the new file pointer, or -1 with r->_errno set on failure.
+static int64_t _ELM_lseek(struct _reent *r, FIL *f, int64_t pos, int whence, int64_t max)
+{
+    FSIZE_t base;
 
     switch (whence)
     {
     case SEEK_SET:
-        off = pos;
+        base = 0;
         break;
     case SEEK_CUR:
-        off = f_tell(f) + pos;
+        base = f_tell(f);
         break;
     case SEEK_END:
-        off = f_size(f) - pos;
+        base = f_size(f);
         break;
     default:
         r->_errno = EINVAL;
         return -1;
     }
 
-    if (pos < 0 && off < -pos)
+    if (pos < 0 && base < (FSIZE_t)-pos)
     {
         /* don't allow seek to before the beginning of the file */
         r->_errno = EINVAL;
         return -1;
     }
+    if (pos > 0 && base + pos > (uint64_t)max)
+    {
+        /* the new position can not be represented by the caller */
+        r->_errno = EOVERFLOW;
+        return -1;
+    }
+
+    FRESULT res = f_lseek(f, base + pos);
+    return _ELM_errnoparse(r, res, 0, -1) ? -1 : (int64_t)f->fptr;
+}
+#endif
 
-    elm_error = f_lseek(f, off);
-    return (off_t)_ELM_errnoparse(r, f->fptr, -1);
+off_t _ELM_seek_r(struct _reent *r, void *fd, off_t pos, int whence)
+{
+#if FF_FS_MINIMIZE < 3
+    return (off_t)_ELM_lseek(r, (FIL *)fd, pos, whence, ELM_OFF_MAX);
 #else
     r->_errno = ENOSYS;
     return -1;
@@ -335,13 +384,23 @@ int _ELM_fstat_r(struct _reent *r, void *fd, struct stat *st)
 {
 #if FF_FS_MINIMIZE < 1
     FIL *fp = (FIL *)fd;
+    if (fp->obj.objsize > (uint64_t)ELM_OFF_MAX)
+    {
+        /* the file size can not be represented by st_size */
+        r->_errno = EOVERFLOW;
+        return -1;
+    }
     memset(st, 0, sizeof(*st));
     st->st_nlink = 1;
     st->st_uid = 1;
     st->st_gid = 2;
-    st->st_size = fp->obj.objsize;
+    st->st_size = (off_t)fp->obj.objsize;
     st->st_spare4[0] = fp->obj.attr;
     st->st_ino = fp->obj.sclust;
+#if FF_STAT_BLKSIZE
+    // newlib sizes the stream buffer by st_blksize.
+    st->st_blksize = ELM_SS(fp->obj.fs) * fp->obj.fs->csize;
+#endif
     return 0;
 #else
     r->_errno = ENOSYS;
@@ -349,11 +408,15 @@ int _ELM_fstat_r(struct _reent *r, void *fd, struct stat *st)
 #endif
 }
 
-static void _ELM_fileinfo_to_stat(const FILINFO *info, struct stat *st)
+// Fills st from info. Returns false if the file size can not be
+// represented by st_size.
+static bool _ELM_fileinfo_to_stat(const FILINFO *info, struct stat *st)
 {
     /* Date of last modification */
     struct tm date;
     memset(st, 0, sizeof(struct stat));
+    if (info->fsize > (uint64_t)ELM_OFF_MAX)
+        return false;
     date.tm_mday = info->fdate & 31;
     date.tm_mon = ((info->fdate >> 5) & 15) - 1;
     date.tm_year = ((info->fdate >> 9) & 127) - 1980 + 1900;
@@ -375,6 +438,7 @@ static void _ELM_fileinfo_to_stat(const FILINFO *info, struct stat *st)
     {
         st->st_mode = S_IFREG | S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH | S_IWOTH;
     }
+    return true;
 }
 
 static int _ELM_chk_mounted(int disk)
@@ -411,27 +475,29 @@ static void _ELM_disk_to_stat(int disk, struct stat *st)
 int _ELM_stat_r(struct _reent *r, const char *file, struct stat *st)
 {
 #if FF_FS_MINIMIZE < 1
-    size_t len = 0;
-    TCHAR *p = mbstoucs2(_ELM_realpath(file), &len);
-
-    // chop off trailing slash
-    if (p[len - 1] == L'/')
-        p[len - 1] = L'\0';
-
     int vol;
 
     if ((vol = get_vol(file)) != -1)
     {
         _ELM_disk_to_stat(vol, st);
-        return _ELM_errnoparse(r, 0, -1);
+        return 0;
     }
 
+    TCHAR pathBuf[PATH_BUF_SIZE];
+    const TCHAR *p = path_to_tchar(pathBuf, _ELM_realpath(file), NULL);
+
     FILINFO fi;
     fi.fsize = sizeof(fi.fname) / sizeof(fi.fname[0]);
 
-    elm_error = f_stat(p, &fi);
-    _ELM_fileinfo_to_stat(&fi, st);
-    return _ELM_errnoparse(r, 0, -1);
+    FRESULT res = f_stat(p, &fi);
+    if (res != FR_OK)
+        return _ELM_errnoparse(r, res, 0, -1);
+    if (!_ELM_fileinfo_to_stat(&fi, st))
+    {
+        r->_errno = EOVERFLOW;
+        return -1;
+    }
+    return 0;
 #else
     r->_errno = ENOSYS;
     return -1;
@@ -447,13 +513,11 @@ int _ELM_link_r(struct _reent *r, const char *existing, const char *newLink)
 int _ELM_unlink_r(struct _reent *r, const char *path)
 {
 #if (FF_FS_MINIMIZE < 1) && (!FF_FS_READONLY)
-    size_t len = 0;
-    TCHAR *p = mbstoucs2(_ELM_realpath(path), &len);
-    if (p[len - 1] == L'/')
-        p[len - 1] = L'\0';
+    TCHAR pathBuf[PATH_BUF_SIZE];
+    const TCHAR *p = path_to_tchar(pathBuf, _ELM_realpath(path), NULL);
 
-    elm_error = f_unlink(p);
-    return _ELM_errnoparse(r, 0, -1);
+    FRESULT res = f_unlink(p);
+    return _ELM_errnoparse(r, res, 0, -1);
 #else
     r->_errno = ENOSYS;
     return -1;
@@ -473,33 +537,21 @@ int _ELM_rmdir_r(struct _reent *r, const char *path)
 int _ELM_chdir_r(struct _reent *r, const char *path)
 {
 #if FF_FS_RPATH
-    size_t len = 0;
-    char *drive = strchr(path, ':');
-    TCHAR *p = mbstoucs2(_ELM_realpath(path), &len);
+    TCHAR pathBuf[PATH_BUF_SIZE];
+    const TCHAR *p = path_to_tchar(pathBuf, _ELM_realpath(path), NULL);
 
-    if (drive != NULL)
-    {
-        char _drive = drive[1];
-        drive[1] = '\0';
-        elm_error = f_chdrive(p);
-        if (elm_error)
-            return _ELM_errnoparse(r, 0, -1);
-        drive[1] = _drive;
-    }
+    FRESULT res;
 
-    /* 
-     * FatFs expects no trailing slash 
-     * drive[2] != '\0' is a check to ensure 
-     * parent drive is not root.
-     */
-    if (drive[2] != '\0' && (len > 1 && p[len - 1] == L'/'))
+    // f_chdrive only reads the drive prefix of the path.
+    if (strchr(path, ':') != NULL)
     {
-        p[len - 1] = L'\0';
-        --len;
+        res = f_chdrive(p);
+        if (res)
+            return _ELM_errnoparse(r, res, 0, -1);
     }
 
-    elm_error = f_chdir(p);
-    return _ELM_errnoparse(r, 0, -1);
+    res = f_chdir(p);
+    return _ELM_errnoparse(r, res, 0, -1);
 #else
     r->_errno = ENOSYS;
     return -1;
@@ -509,14 +561,13 @@ int _ELM_chdir_r(struct _reent *r, const char *path)
 int _ELM_rename_r(struct _reent *r, const char *path, const char *pathp)
 {
 #if (FF_FS_MINIMIZE < 1) && (!FF_FS_READONLY)
-    TCHAR p[FF_MAX_LFN + 1];
-    const TCHAR *pp;
-    tonccpy(p, mbstoucs2(_ELM_realpath(path), NULL), sizeof(p));
-    pp = mbstoucs2(_ELM_realpath(pathp), NULL);
+    TCHAR pathBuf[PATH_BUF_SIZE], newPathBuf[PATH_BUF_SIZE];
+    const TCHAR *p = path_to_tchar(pathBuf, _ELM_realpath(path), NULL);
+    const TCHAR *pp = path_to_tchar(newPathBuf, _ELM_realpath(pathp), NULL);
     if ((pp[0] == L'0' || pp[0] == L'1') && pp[1] == L':')
         pp += 2;
-    elm_error = f_rename(p, pp);
-    return _ELM_errnoparse(r, 0, -1);
+    FRESULT res = f_rename(p, pp);
+    return _ELM_errnoparse(r, res, 0, -1);
 #else
     r->_errno = ENOSYS;
     return -1;
@@ -526,9 +577,10 @@ int _ELM_rename_r(struct _reent *r, const char *path, const char *pathp)
 int _ELM_mkdir_r(struct _reent *r, const char *path, int mode)
 {
 #if (FF_FS_MINIMIZE < 1) && (!FF_FS_READONLY)
-    const TCHAR *p = mbstoucs2(_ELM_realpath(path), NULL);
-    elm_error = f_mkdir(p);
-    return _ELM_errnoparse(r, 0, -1);
+    TCHAR pathBuf[PATH_BUF_SIZE];
+    const TCHAR *p = path_to_tchar(pathBuf, _ELM_realpath(path), NULL);
+    FRESULT res = f_mkdir(p);
+    return _ELM_errnoparse(r, res, 0, -1);
 #else
     r->_errno = ENOSYS;
     return -1;
@@ -538,20 +590,12 @@ int _ELM_mkdir_r(struct _reent *r, const char *path, int mode)
 DIR_ITER *_ELM_diropen_r(struct _reent *r, DIR_ITER *dirState, const char *path)
 {
 #if FF_FS_MINIMIZE < 2
-    size_t len = 0;
-    TCHAR *p = mbstoucs2(_ELM_realpath(path), &len);
-
-    if (len > 1 && p[len - 1] == L'/')
-    {
-        p[len - 1] = L'\0';
-        --len;
-    }
+    TCHAR pathBuf[PATH_BUF_SIZE];
+    const TCHAR *p = path_to_tchar(pathBuf, _ELM_realpath(path), NULL);
 
     DIR_EX *dir = (DIR_EX *)dirState->dirStruct;
-    tonccpy(dir->name, (void *)p, (len + 1) * sizeof(TCHAR));
-    dir->namesize = len + 1;
-    elm_error = f_opendir(&(dir->dir), p);
-    return (DIR_ITER *)_ELM_errnoparse(r, (int)dirState, 0);
+    FRESULT res = f_opendir(&(dir->dir), p);
+    return (DIR_ITER *)_ELM_errnoparse(r, res, (int)dirState, 0);
 #else
     r->_errno = ENOSYS;
     return 0;
@@ -562,8 +606,8 @@ int _ELM_dirreset_r(struct _reent *r, DIR_ITER *dirState)
 {
 #if FF_FS_MINIMIZE < 2
     DIR_EX *dir = (DIR_EX *)dirState->dirStruct;
-    elm_error = f_readdir(&(dir->dir), NULL);
-    return _ELM_errnoparse(r, 0, -1);
+    FRESULT res = f_readdir(&(dir->dir), NULL);
+    return _ELM_errnoparse(r, res, 0, -1);
 #else
     r->_errno = ENOSYS;
     return -1;
@@ -576,24 +620,26 @@ int _ELM_dirnext_r(struct _reent *r, DIR_ITER *dirState, char *filename, struct
     FILINFO fi;
     fi.fsize = sizeof(fi.fname) / sizeof(fi.fname[0]);
     DIR_EX *dir = (DIR_EX *)dirState->dirStruct;
-    elm_error = f_readdir(&(dir->dir), &fi);
-    if (elm_error != FR_OK)
-        return _ELM_errnoparse(r, 0, -1);
+    FRESULT res = f_readdir(&(dir->dir), &fi);
+    if (res != FR_OK)
+        return _ELM_errnoparse(r, res, 0, -1);
     if (!fi.fname[0])
         return -1;
 #ifdef FF_USE_LFN
-    ucs2tombs(filename, fi.fname);
+    // filename is the d_name of a struct dirent
+    size_t len = tchar_to_mbsn(filename, fi.fname, NAME_MAX + 1);
+    if (len == CVT_TOOLONG || len == CVT_INVALID)
+    {
+        r->_errno = len == CVT_TOOLONG ? ENAMETOOLONG : EILSEQ;
+        return -1;
+    }
 #else
     strcpy(filename, fi.fname);
 #endif
-    if (st != NULL)
+    if (st != NULL && !_ELM_fileinfo_to_stat(&fi, st))
     {
-        TCHAR path[FF_MAX_LFN + 1];
-        size_t len = 0;
-        tonccpy(path, dir->name, (dir->namesize - 1) * sizeof(TCHAR));
-        path[dir->namesize - 1] = L'/';
-        tonccpy(path + dir->namesize, mbstoucs2(filename, &len), (len + 1) * sizeof(TCHAR));
-        _ELM_fileinfo_to_stat(&fi, st);
+        r->_errno = EOVERFLOW;
+        return -1;
     }
     return 0;
 #else
@@ -607,35 +653,393 @@ int _ELM_dirclose_r(struct _reent *r, DIR_ITER *dirState)
     return _ELM_dirreset_r(r, dirState);
 }
 
-int _ELM_statvfs_r(struct _reent *r, const char *path, struct statvfs *buf)
+FAT_DIR *fatOpenDir(const char *path)
+{
+    return fatOpenDirFiltered(path, NULL);
+}
+
+FAT_DIR *fatOpenDirFiltered(const char *path, const char *pattern)
+{
+#if FF_FS_MINIMIZE < 2
+    size_t patternLen = 0;
+    TCHAR pathBuf[PATH_BUF_SIZE];
+    const TCHAR *p = NULL;
+
+#if FF_USE_FIND
+    if (pattern != NULL)
+        p = path_to_tchar(pathBuf, pattern, &patternLen);
+#else
+    if (pattern != NULL)
+    {
+        errno = ENOSYS;
+        return NULL;
+    }
+#endif
+
+    FAT_DIR *dir = ff_memalloc(sizeof(FAT_DIR) + (patternLen + 1) * sizeof(TCHAR));
+    if (dir == NULL)
+    {
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    dir->hasPending = false;
+    dir->filtered = pattern != NULL;
+    dir->error = 0;
+    dir->pattern[0] = L'\0';
+    if (p != NULL)
+        tonccpy(dir->pattern, p, (patternLen + 1) * sizeof(TCHAR));
+
+    p = path_to_tchar(pathBuf, _ELM_realpath(path), NULL);
+
+    FRESULT res;
+#if FF_USE_FIND
+    if (dir->filtered)
+    {
+        // f_findfirst reads the first matching entry ahead.
+        res = f_findfirst(&(dir->dir), &(dir->pending), p, dir->pattern);
+        dir->hasPending = res == FR_OK && dir->pending.fname[0];
+    }
+    else
+#endif
+        res = f_opendir(&(dir->dir), p);
+    if (res != FR_OK)
+    {
+        ff_memfree(dir);
+        return (FAT_DIR *)_ELM_errnoparse(_REENT, res, 0, 0);
+    }
+    return dir;
+#else
+    errno = ENOSYS;
+    return NULL;
+#endif
+}
+
+int fatReadDirBatch(FAT_DIR *dir, FAT_DIRENT *entries, int count, char *names, size_t namesSize)
+{
+#if FF_FS_MINIMIZE < 2
+    if (dir->error)
+    {
+        // Report the error that ended the last batch
+        errno = dir->error;
+        dir->error = 0;
+        return -1;
+    }
+
+    int n = 0;
+    int error = 0;
+    while (n < count)
+    {
+        FILINFO *fi = &dir->pending;
+        if (!dir->hasPending)
+        {
+            FRESULT res;
+#if FF_USE_FIND
+            if (dir->filtered)
+                res = f_findnext(&(dir->dir), fi);
+            else
+#endif
+                res = f_readdir(&(dir->dir), fi);
+            if (res != FR_OK)
+            {
+                error = _ELM_errno(res);
+                break;
+            }
+            if (!fi->fname[0])
+                break;
+            dir->hasPending = true;
+        }
+
+        size_t written = tchar_to_mbsn(names, fi->fname, namesSize);
+        if (written == CVT_TOOLONG)
+            break;
+        if (written == CVT_INVALID)
+        {
+            // Drop the entry, but fail so that the listing is not silently incomplete
+            dir->hasPending = false;
+            error = EILSEQ;
+            break;
+        }
+
+        entries[n].name = names;
+        entries[n].size = fi->fsize;
+        entries[n].cluster = fi->fclust;
+        entries[n].date = fi->fdate;
+        entries[n].time = fi->ftime;
+        entries[n].attr = fi->fattrib;
+        names += written + 1;
+        namesSize -= written + 1;
+        dir->hasPending = false;
+        n++;
+    }
+
+    if (error)
+    {
+        // The directory has moved past the entries read so far, so return them first
+        if (n > 0)
+        {
+            dir->error = error;
+            return n;
+        }
+        errno = error;
+        return -1;
+    }
+    if (n == 0 && count > 0 && dir->hasPending)
+    {
+        // Not even one name fits in the buffer
+        errno = ENAMETOOLONG;
+        return -1;
+    }
+    return n;
+#else
+    errno = ENOSYS;
+    return -1;
+#endif
+}
+
+int fatRewindDir(FAT_DIR *dir)
+{
+#if FF_FS_MINIMIZE < 2
+    dir->hasPending = false;
+    dir->error = 0;
+    FRESULT res = f_readdir(&(dir->dir), NULL);
+    return _ELM_errnoparse(_REENT, res, 0, -1);
+#else
+    errno = ENOSYS;
+    return -1;
+#endif
+}
+
+int fatCloseDir(FAT_DIR *dir)
+{
+    if (dir == NULL)
+        return 0;
+    FRESULT res = FR_OK;
+#if FF_FS_MINIMIZE < 2
+    res = f_closedir(&(dir->dir));
+#endif
+    ff_memfree(dir);
+    return _ELM_errnoparse(_REENT, res, 0, -1);
+}
+
+FAT_FILE *fatOpen(const char *path, int flags)
+{
+    FAT_FILE *file = ff_memalloc(sizeof(FAT_FILE));
+    if (file == NULL)
+    {
+        errno = ENOMEM;
+        return NULL;
+    }
+    if (_ELM_open_r(_REENT, &(file->fil), path, flags, 0) == -1)
+    {
+        ff_memfree(file);
+        return NULL;
+    }
+    file->atPtr = 0;
+    file->atClust = 0;
+    slim_lock_init(&(file->lock));
+    return file;
+}
+
+ssize_t fatRead(FAT_FILE *file, void *buf, size_t len)
+{
+    slim_lock(&(file->lock));
+    ssize_t ret = _ELM_read_r(_REENT, &(file->fil), buf, len);
+    slim_unlock(&(file->lock));
+    return ret;
+}
+
+ssize_t fatWrite(FAT_FILE *file, const void *buf, size_t len)
+{
+    slim_lock(&(file->lock));
+    ssize_t ret = _ELM_write_r(_REENT, &(file->fil), buf, len);
+    slim_unlock(&(file->lock));
+    return ret;
+}
+
+int64_t fatSeek(FAT_FILE *file, int64_t offset, int whence)
+{
+#if FF_FS_MINIMIZE < 3
+    slim_lock(&(file->lock));
+    int64_t ret = _ELM_lseek(_REENT, &(file->fil), offset, whence, INT64_MAX);
+    slim_unlock(&(file->lock));
+    return ret;
+#else
+    errno = ENOSYS;
+    return -1;
+#endif
+}
+
+#if FF_FS_MINIMIZE < 3
+// Moves the file pointer to ofs for a positional access. Without a fast seek
+// map, f_lseek walks the cluster chain from the current cluster when seeking
+// forward and from the first cluster otherwise, so the walk is started from
+// the end of the last positional access instead whenever that is closer.
+static FRESULT _ELM_seekat(FAT_FILE *file, FSIZE_t ofs)
 {
-    size_t len = 0;
-    TCHAR *p = mbstoucs2(_ELM_realpath(path), &len);
+    FIL *fp = &(file->fil);
+#if FF_USE_FASTSEEK
+    BYTE resume = fp->cltbl == NULL;
+#else
+    BYTE resume = 1;
+#endif
+    if (resume && file->atPtr > 0 && file->atPtr <= ofs && file->atPtr <= fp->obj.objsize &&
+        (fp->fptr > ofs || fp->fptr < file->atPtr))
+    {
+        fp->fptr = file->atPtr;
+        fp->clust = file->atClust;
+    }
+    return f_lseek(fp, ofs);
+}
 
+// Remembers where a positional access ended, and moves the file pointer back
+// to fptr in clust, reloading the data window if needed.
+static FRESULT _ELM_endat(FAT_FILE *file, FSIZE_t fptr, DWORD clust)
+{
+    FIL *fp = &(file->fil);
+    file->atPtr = fp->fptr;
+    file->atClust = fp->clust;
+    fp->fptr = fptr;
+    fp->clust = clust;
+    return f_lseek(fp, fptr);
+}
+#endif
+
+ssize_t fatReadAt(FAT_FILE *file, void *buf, size_t len, int64_t offset)
+{
+#if FF_FS_MINIMIZE < 3
+    if (offset < 0)
+    {
+        errno = EINVAL;
+        return -1;
+    }
+
+    slim_lock(&(file->lock));
+    FIL *fp = &(file->fil);
+    FSIZE_t fptr = fp->fptr;
+    DWORD clust = fp->clust;
+    UINT read = 0;
+    FRESULT res = FR_OK;
+
+    // f_lseek extends files opened for writing, so never seek past the end
+    if ((uint64_t)offset < f_size(fp))
+    {
+        res = _ELM_seekat(file, (FSIZE_t)offset);
+        if (res == FR_OK)
+        {
+            res = f_read(fp, buf, (UINT)len, &read);
+            FRESULT endRes = _ELM_endat(file, fptr, clust);
+            if (res == FR_OK)
+                res = endRes;
+        }
+    }
+    slim_unlock(&(file->lock));
+    return _ELM_errnoparse(_REENT, res, read, -1);
+#else
+    errno = ENOSYS;
+    return -1;
+#endif
+}
+
+ssize_t fatWriteAt(FAT_FILE *file, const void *buf, size_t len, int64_t offset)
+{
+#if FF_FS_MINIMIZE < 3 && !FF_FS_READONLY
+    if (offset < 0)
+    {
+        errno = EINVAL;
+        return -1;
+    }
+    if ((uint64_t)offset > (FSIZE_t)-1)
+    {
+        errno = EFBIG;
+        return -1;
+    }
+
+    slim_lock(&(file->lock));
+    FIL *fp = &(file->fil);
+    FSIZE_t fptr = fp->fptr;
+    DWORD clust = fp->clust;
+    UINT written = 0;
+
+    if (!(fp->flag & FA_WRITE))
+    {
+        slim_unlock(&(file->lock));
+        errno = EBADF;
+        return -1;
+    }
+
+    FSIZE_t size = f_size(fp);
+    FRESULT res = _ELM_seekat(file, (FSIZE_t)offset);
+    if (res == FR_OK)
+    {
+        BYTE extended = fp->fptr == (FSIZE_t)offset;
+        if (extended)
+        {
+            res = f_write(fp, buf, (UINT)len, &written);
+        }
+        else if (fp->fptr > size)
+        {
+            // Nothing is written, so give back the clusters the partial extension took
+            res = f_lseek(fp, size);
+            if (res == FR_OK)
+                res = f_truncate(fp);
+        }
+        FRESULT endRes = _ELM_endat(file, fptr, clust);
+        if (res == FR_OK)
+            res = endRes;
+        if (res == FR_OK && !extended)
+        {
+            // The file could not be extended up to offset
+            slim_unlock(&(file->lock));
+            errno = ENOSPC;
+            return -1;
+        }
+    }
+    slim_unlock(&(file->lock));
+    return _ELM_errnoparse(_REENT, res, written, -1);
+#else
+    errno = ENOSYS;
+    return -1;
+#endif
+}
+
+int fatClose(FAT_FILE *file)
+{
+    if (file == NULL)
+        return 0;
+    int ret = _ELM_close_r(_REENT, &(file->fil));
+    slim_lock_destroy(&(file->lock));
+    ff_memfree(file);
+    return ret;
+}
+
+int _ELM_statvfs_r(struct _reent *r, const char *path, struct statvfs *buf)
+{
     int vol;
 
-    if ((vol = get_vol(path) != -1))
+    if ((vol = get_vol(path)) != -1)
     {
         DWORD nclust;
         FATFS *fat = &_elm[vol];
-        elm_error = f_getfree(p, &nclust, &fat);
+        FRESULT res = f_getfree(get_vol_root(vol), &nclust, &fat);
 
-        buf->f_bsize = ELM_SS(fat);
-        buf->f_frsize = ELM_SS(fat);
+        // Counts are in clusters, so that they fit in 32 bits on large exFAT volumes.
+        buf->f_bsize = ELM_SS(fat) * fat->csize;
+        buf->f_frsize = ELM_SS(fat) * fat->csize;
 
-        buf->f_blocks = (fat->n_fatent - 2) * fat->csize;
-        buf->f_bfree = nclust * fat->csize;
+        buf->f_blocks = fat->n_fatent - 2;
+        buf->f_bfree = nclust;
         buf->f_bavail = buf->f_bfree;
 
-        buf->f_files = (fat->n_fatent - 2) * fat->csize;
-        buf->f_ffree = nclust * fat->csize;
+        buf->f_files = fat->n_fatent - 2;
+        buf->f_ffree = nclust;
         buf->f_favail = buf->f_bfree;
         buf->f_fsid = fat->fs_type;
 
         buf->f_namemax = FF_MAX_LFN;
         buf->f_flag = ST_NOSUID /* No support for ST_ISUID and ST_ISGID file mode bits */
                       | (FF_FS_READONLY ? ST_RDONLY /* Read only file system */ : 0);
-        return _ELM_errnoparse(r, 0, -1);
+        return _ELM_errnoparse(r, res, 0, -1);
     }
     return -1;
 }
@@ -644,15 +1048,20 @@ int _ELM_ftruncate_r(struct _reent *r, void *fd, off_t len)
 {
 #if (_FS_MINIMIZE < 1) && (!FF_FS_READONLY)
     FIL *fp = (FIL *)fd;
-    int ptr = fp->fptr;
-    elm_error = f_lseek(fp, len);
-    if (elm_error != FR_OK)
-        return _ELM_errnoparse(r, 0, -1);
-    elm_error = f_truncate(fp);
-    if (elm_error != FR_OK)
-        return _ELM_errnoparse(r, 0, -2);
-    fp->fptr = ptr;
-    return 0;
+    FSIZE_t ptr = fp->fptr;
+    FRESULT res = f_lseek(fp, len);
+    if (res != FR_OK)
+        return _ELM_errnoparse(r, res, 0, -1);
+    res = f_truncate(fp);
+    if (res != FR_OK)
+        return _ELM_errnoparse(r, res, 0, -2);
+    // Seeking past the new end would extend the file again, so a pointer
+    // beyond it is left at the end.
+    if (ptr < fp->fptr)
+    {
+        res = f_lseek(fp, ptr);
+    }
+    return _ELM_errnoparse(r, res, 0, -1);
 #else
     r->_errno = ENOSYS;
     return -1;
@@ -662,8 +1071,8 @@ int _ELM_ftruncate_r(struct _reent *r, void *fd, off_t len)
 int _ELM_fsync_r(struct _reent *r, void *fd)
 {
 #if !FF_FS_READONLY
-    elm_error = f_sync((FIL *)fd);
-    return _ELM_errnoparse(r, 0, -1);
+    FRESULT res = f_sync((FIL *)fd);
+    return _ELM_errnoparse(r, res, 0, -1);
 #else
     r->_errno = ENOSYS;
     return -1;
@@ -678,9 +1087,7 @@ bool fatMountSimple(const char *mount, const DISC_INTERFACE *interface)
         return false;
     configure_disc_io(vol, interface);
 
-    size_t len = 0;
-    TCHAR *m = mbstoucs2(mount, &len);
-    if (f_mount(&(_elm[vol]), m, 1) != FR_OK)
+    if (f_mount(&(_elm[vol]), get_vol_root(vol), 1) != FR_OK)
     {
         return false;
     }
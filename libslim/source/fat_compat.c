@@ -57,8 +57,8 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 bool fatUnmount(const char *mount)
 {
     RemoveDevice(mount);
-    size_t len = 0;
-    TCHAR *m = mbstoucs2(mount, &len);
+    TCHAR pathBuf[PATH_BUF_SIZE];
+    const TCHAR *m = path_to_tchar(pathBuf, mount, NULL);
     if (f_mount(NULL, m, 1) != FR_OK)
     {
         return false;
@@ -90,20 +90,18 @@ bool fatInit(uint32_t cacheSize, bool _configureDefault)
 void fatGetVolumeLabel(const char *mount, char *label)
 {
     int vol = get_vol(mount);
-    size_t len = 0;
     if (vol == -1)
         return;
     TCHAR label_buf[255] = {0};
-    TCHAR *p = mbstoucs2(mount, &len);
-    f_getlabel(p, label_buf, NULL);
-    ucs2tombs(label, label_buf);
+    f_getlabel(get_vol_root(vol), label_buf, NULL);
+    tchar_to_mbs(label, label_buf);
 }
 
 int FAT_getAttr(const char *file)
 {
     FILINFO stat;
-    size_t len = 0;
-    TCHAR *p = mbstoucs2(file, &len);
+    TCHAR pathBuf[PATH_BUF_SIZE];
+    const TCHAR *p = path_to_tchar(pathBuf, file, NULL);
     if (f_stat(p, &stat) == FR_OK)
     {
         return stat.fattrib;
@@ -113,8 +111,8 @@ int FAT_getAttr(const char *file)
 
 int FAT_setAttr(const char *file, uint8_t attr)
 {
-    size_t len = 0;
-    TCHAR *p = mbstoucs2(file, &len);
+    TCHAR pathBuf[PATH_BUF_SIZE];
+    const TCHAR *p = path_to_tchar(pathBuf, file, NULL);
     if (f_chmod(p, attr, AM_RDO | AM_SYS | AM_HID) == FR_OK)
     {
         return 0;
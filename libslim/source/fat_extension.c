@@ -89,3 +89,128 @@ bool configureCache(uint32_t cacheSize)
 {
     return cache_init(cacheSize) != NULL;
 }
+
+bool configureAllocator(void *(*alloc)(size_t size), void (*free)(void *ptr))
+{
+    return ff_memconfig(alloc, free);
+}
+
+bool configureSectorSize(const char *mount, uint16_t sectorSize)
+{
+    volno_t vol = get_vol(mount);
+    if (vol == -1)
+        return false;
+    return configure_disc_ssize(vol, sectorSize);
+}
+
+bool configureMaxSectors(const char *mount, uint32_t maxSectors)
+{
+    volno_t vol = get_vol(mount);
+    if (vol == -1)
+        return false;
+    return configure_disc_max_sectors(vol, maxSectors);
+}
+
+bool configureDiscard(const char *mount, bool (*discard)(sec_t sector, sec_t numSectors))
+{
+    volno_t vol = get_vol(mount);
+    if (vol == -1)
+        return false;
+    return configure_disc_discard(vol, discard);
+}
+
+#if FF_USE_MKFS
+// Number of sectors cleared per write while formatting.
+#define FORMAT_BUF_SECTORS 64
+
+#define KiB(n) ((uint64_t)(n) << 10)
+#define MiB(n) ((uint64_t)(n) << 20)
+#define GiB(n) ((uint64_t)(n) << 30)
+
+// Picks the file system, cluster size and erase block size the SD Association
+// recommends for an SD card of the given size.
+static void format_defaults(uint64_t size, BYTE *fmt, uint32_t *clusterSize, uint32_t *eraseBlockSize)
+{
+    if (size > GiB(32))
+    {
+        // SDXC
+#if FF_FS_EXFAT
+        *fmt = FM_EXFAT;
+        *clusterSize = size > GiB(512) ? KiB(256) : KiB(128);
+#else
+        *fmt = FM_FAT32;
+        *clusterSize = KiB(32);
+#endif
+        *eraseBlockSize = MiB(16);
+    }
+    else
+    {
+        // SDSC and SDHC. FatFs moves up to FAT32 once FAT16 runs out of clusters.
+        *fmt = FM_FAT | FM_FAT32;
+        *clusterSize = size < MiB(512) ? KiB(16) : KiB(32);
+        *eraseBlockSize = MiB(4);
+    }
+
+    // Small devices have smaller erase blocks, and should not lose much space to alignment.
+    while (*eraseBlockSize > *clusterSize && *eraseBlockSize > size / 64)
+        *eraseBlockSize /= 2;
+}
+
+bool fatFormat(const char *mount, const DISC_INTERFACE *interface, const FAT_FORMAT *options)
+{
+    static const FAT_FORMAT defaults = {0};
+    volno_t vol = get_vol(mount);
+    if (vol == -1)
+        return false;
+    if (!options)
+        options = &defaults;
+    // A volume's interface can not be reconfigured once set, so formatting with
+    // another one would silently format the old device.
+    if (interface && !configure_disc_io(vol, interface) && get_disc_io(vol) != interface)
+        return false;
+    if (!get_disc_io(vol))
+        return false;
+
+    fatUnmount(mount);
+    if (options->sectorCount)
+        configure_disc_sectors(vol, options->sectorCount);
+    if (disk_initialize(vol) & STA_NOINIT)
+        return false;
+
+    LBA_t sectors = 0;
+    UINT ss = get_disc_ssize(vol);
+    if (disk_ioctl(vol, GET_SECTOR_COUNT, &sectors) != RES_OK)
+        return false;
+
+    BYTE fmt;
+    uint32_t clusterSize, eraseBlockSize;
+    format_defaults((uint64_t)sectors * ss, &fmt, &clusterSize, &eraseBlockSize);
+    if (options->type)
+    {
+        // The recommended cluster size may not be valid for another file system,
+        // so let FatFs pick one unless it was given.
+        fmt = options->type & (FM_FAT | FM_FAT32 | FM_EXFAT);
+        clusterSize = 0;
+    }
+    if (options->clusterSize)
+        clusterSize = options->clusterSize;
+    if (options->eraseBlockSize)
+        eraseBlockSize = options->eraseBlockSize;
+    if (options->noPartition)
+        fmt |= FM_SFD;
+
+    MKFS_PARM opt = {0};
+    opt.fmt = fmt;
+    opt.n_fat = (fmt & FM_EXFAT) ? 1 : 2;
+    opt.align = eraseBlockSize / ss ? eraseBlockSize / ss : 1;
+    opt.au_size = clusterSize;
+
+    const TCHAR *m = get_vol_root(vol);
+    FRESULT res = f_mkfs(m, &opt, NULL, FORMAT_BUF_SECTORS * ss);
+    if (res == FR_NOT_ENOUGH_CORE)
+        res = f_mkfs(m, &opt, NULL, ss);
+    if (res != FR_OK)
+        return false;
+    return fatMountSimple(mount, get_disc_io(vol));
+}
+#endif
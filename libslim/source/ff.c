@@ -54,6 +54,39 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "memcopy.h" 	
 /* --- BEGIN LIBSLIM PATCH: FEAT_FAST_MEM_FUNC --- */
 
+/* --- BEGIN LIBSLIM PATCH: FEAT_DIR_INDEX --- */
+#if FF_USE_DIR_INDEX
+#if !FF_USE_LFN
+#error Directory name index needs LFN to be enabled
+#endif
+#include "dirindex.h"
+#endif
+/* --- END LIBSLIM PATCH: FEAT_DIR_INDEX --- */
+
+/* --- BEGIN LIBSLIM PATCH: FEAT_PATH_CACHE --- */
+#if FF_USE_PATH_CACHE
+#include "pathcache.h"
+#endif
+/* --- END LIBSLIM PATCH: FEAT_PATH_CACHE --- */
+
+/* --- BEGIN LIBSLIM PATCH: FEAT_NEG_CACHE --- */
+#if FF_USE_NEG_CACHE
+#if !FF_USE_LFN
+#error Negative lookup cache needs LFN to be enabled
+#endif
+#include "negcache.h"
+#endif
+/* --- END LIBSLIM PATCH: FEAT_NEG_CACHE --- */
+
+/* --- BEGIN LIBSLIM PATCH: FEAT_VOL_PREFIX --- */
+#if FF_STR_VOLUME_ID == 1 && !(FF_USE_LFN && (FF_LFN_UNICODE == 1 || FF_LFN_UNICODE == 3))
+#define VOL_PREFIX_TABLE 1	/* TCHAR is char, so volume IDs are matched by the prefix table of ffvolumes.c */
+#include "ffvolumes.h"
+#else
+#define VOL_PREFIX_TABLE 0
+#endif
+/* --- END LIBSLIM PATCH: FEAT_VOL_PREFIX --- */
+
 /*--------------------------------------------------------------------------
 
    Module Private Definitions
@@ -565,11 +598,11 @@ static WCHAR LfnBuf[FF_MAX_LFN + 1];		/* LFN working buffer */
 #elif FF_USE_LFN == 3 	/* LFN enabled with dynamic working buffer on the heap */
 #if FF_FS_EXFAT
 #define DEF_NAMBUF		WCHAR *lfn;	/* Pointer to LFN working buffer and directory entry block scratchpad buffer */
-#define INIT_NAMBUF(fs)	{ lfn = ff_memalloc((FF_MAX_LFN+1)*2 + MAXDIRB(FF_MAX_LFN)); if (!lfn) LEAVE_FF(fs, FR_NOT_ENOUGH_CORE); (fs)->lfnbuf = lfn; (fs)->dirbuf = (BYTE*)(lfn+FF_MAX_LFN+1); }
+#define INIT_NAMBUF(fs)	{ lfn = ff_poolalloc((FF_MAX_LFN+1)*2 + MAXDIRB(FF_MAX_LFN)); if (!lfn) LEAVE_FF(fs, FR_NOT_ENOUGH_CORE); (fs)->lfnbuf = lfn; (fs)->dirbuf = (BYTE*)(lfn+FF_MAX_LFN+1); }
 #define FREE_NAMBUF()	ff_memfree(lfn)
 #else
 #define DEF_NAMBUF		WCHAR *lfn;	/* Pointer to LFN working buffer */
-#define INIT_NAMBUF(fs)	{ lfn = ff_memalloc((FF_MAX_LFN+1)*2); if (!lfn) LEAVE_FF(fs, FR_NOT_ENOUGH_CORE); (fs)->lfnbuf = lfn; }
+#define INIT_NAMBUF(fs)	{ lfn = ff_poolalloc((FF_MAX_LFN+1)*2); if (!lfn) LEAVE_FF(fs, FR_NOT_ENOUGH_CORE); (fs)->lfnbuf = lfn; }
 #define FREE_NAMBUF()	ff_memfree(lfn)
 #endif
 #define LEAVE_MKFS(res)	{ if (!work) ff_memfree(buf); return res; }
@@ -1096,6 +1129,167 @@ static void clear_lock (	/* Clear lock entries of the volume */
 
 
 
+/* --- BEGIN LIBSLIM PATCH: FEAT_FAT_MIRROR --- */
+#if !FF_FS_READONLY && FF_FAT_MIRROR_DEFER
+/*-----------------------------------------------------------------------*/
+/* Reflect pending 1st FAT sectors to the 2nd FAT                        */
+/*-----------------------------------------------------------------------*/
+
+static FRESULT flush_mirror (	/* Returns FR_OK or FR_DISK_ERR */
+	FATFS* fs			/* Filesystem object (window must be clean) */
+)
+{
+	UINT i, j, n, nb;
+	DWORD ofs;
+	BYTE *buf;
+	FRESULT res = FR_OK;
+
+
+	if (fs->n_mirror == 0) return FR_OK;
+
+	for (i = 1; i < fs->n_mirror; i++) {	/* Sort pending sectors in ascending order */
+		ofs = fs->mirror[i];
+		for (j = i; j > 0 && fs->mirror[j - 1] > ofs; j--) fs->mirror[j] = fs->mirror[j - 1];
+		fs->mirror[j] = ofs;
+	}
+	for (n = j = i = 1; i < fs->n_mirror; i++) {	/* Length of the longest run of adjacent sectors */
+		j = (fs->mirror[i] == fs->mirror[i - 1] + 1) ? j + 1 : 1;
+		if (j > n) n = j;
+	}
+
+	/* Allocate a buffer for the longest run, or use the window one sector at a time */
+	buf = (n > 1) ? ff_memalloc(n * SS(fs)) : 0;
+	if (buf) {
+		nb = n;
+	} else {
+		buf = fs->win; nb = 1;
+		fs->winsect = (LBA_t)0 - 1;	/* The window is overwritten below */
+	}
+
+	for (i = 0; i < fs->n_mirror && res == FR_OK; i += n) {
+		for (n = 1; n < nb && i + n < fs->n_mirror && fs->mirror[i + n] == fs->mirror[i] + n; n++) ;	/* Merge adjacent sectors */
+		if (disk_read(fs->pdrv, buf, fs->fatbase + fs->mirror[i], (UINT)n) != RES_OK
+			|| disk_write(fs->pdrv, buf, fs->fatbase + fs->fsize + fs->mirror[i], (UINT)n) != RES_OK) {
+			res = FR_DISK_ERR;
+		}
+	}
+	if (buf != fs->win) ff_memfree(buf);
+
+	if (res == FR_OK) fs->n_mirror = 0;
+	return res;
+}
+
+
+static FRESULT defer_mirror (	/* Returns FR_OK or FR_DISK_ERR */
+	FATFS* fs,			/* Filesystem object (window must be clean) */
+	DWORD ofs			/* Sector offset in the 1st FAT */
+)
+{
+	UINT i;
+
+
+	for (i = 0; i < fs->n_mirror; i++) {	/* Already pending? */
+		if (fs->mirror[i] == ofs) return FR_OK;
+	}
+	if (fs->n_mirror == FF_FAT_MIRROR_DEFER) {	/* Flush the pending sectors if the set is full */
+		if (flush_mirror(fs) != FR_OK) return FR_DISK_ERR;
+	}
+	fs->mirror[fs->n_mirror++] = ofs;
+	return FR_OK;
+}
+#endif
+/* --- END LIBSLIM PATCH: FEAT_FAT_MIRROR --- */
+
+
+/* --- BEGIN LIBSLIM PATCH: FEAT_TRIM_BATCH --- */
+#if !FF_FS_READONLY && FF_USE_TRIM && FF_TRIM_BATCH
+/*-----------------------------------------------------------------------*/
+/* Discard the pending freed sector ranges                               */
+/*-----------------------------------------------------------------------*/
+
+static void flush_trim (
+	FATFS* fs			/* Filesystem object */
+)
+{
+	UINT i, j;
+	LBA_t rt[2];
+
+
+	for (i = 1; i < fs->n_trim; i++) {	/* Sort pending ranges by the start sector */
+		rt[0] = fs->trim[i][0]; rt[1] = fs->trim[i][1];
+		for (j = i; j > 0 && fs->trim[j - 1][0] > rt[0]; j--) {
+			fs->trim[j][0] = fs->trim[j - 1][0]; fs->trim[j][1] = fs->trim[j - 1][1];
+		}
+		fs->trim[j][0] = rt[0]; fs->trim[j][1] = rt[1];
+	}
+	for (i = 0; i < fs->n_trim; i = j) {	/* Discard each run of adjacent ranges at once */
+		rt[0] = fs->trim[i][0]; rt[1] = fs->trim[i][1];
+		for (j = i + 1; j < fs->n_trim && fs->trim[j][0] == rt[1] + 1; j++) rt[1] = fs->trim[j][1];
+		disk_ioctl(fs->pdrv, CTRL_TRIM, rt);	/* Inform storage device that the data in the block may be erased */
+	}
+	fs->n_trim = 0;
+}
+
+
+static void defer_trim (
+	FATFS* fs,			/* Filesystem object */
+	LBA_t start,		/* Start of data area to be freed */
+	LBA_t end			/* End of data area to be freed */
+)
+{
+	UINT i;
+
+
+	for (i = 0; i < fs->n_trim; i++) {	/* Extend a pending range adjacent to the block */
+		if (fs->trim[i][1] + 1 == start) {
+			fs->trim[i][1] = end; return;
+		}
+		if (end + 1 == fs->trim[i][0]) {
+			fs->trim[i][0] = start; return;
+		}
+	}
+	if (fs->n_trim == FF_TRIM_BATCH) flush_trim(fs);	/* Flush the pending ranges if the set is full */
+	fs->trim[fs->n_trim][0] = start; fs->trim[fs->n_trim][1] = end;
+	fs->n_trim++;
+}
+
+
+static void cancel_trim (
+	FATFS* fs,			/* Filesystem object */
+	LBA_t start,		/* Start of data area allocated again */
+	LBA_t end			/* End of data area allocated again */
+)
+{
+	UINT i;
+	LBA_t rt[2];
+
+
+	for (i = 0; i < fs->n_trim; i++) {
+		if (fs->trim[i][1] < start || fs->trim[i][0] > end) continue;	/* Not overlapped? */
+		if (fs->trim[i][0] >= start && fs->trim[i][1] <= end) {	/* Entire range allocated? */
+			fs->n_trim--;
+			fs->trim[i][0] = fs->trim[fs->n_trim][0]; fs->trim[i][1] = fs->trim[fs->n_trim][1];
+			i--;
+		} else if (fs->trim[i][0] >= start) {	/* Head of the range allocated? */
+			fs->trim[i][0] = end + 1;
+		} else if (fs->trim[i][1] <= end) {		/* Tail of the range allocated? */
+			fs->trim[i][1] = start - 1;
+		} else {								/* Middle of the range allocated */
+			rt[0] = end + 1; rt[1] = fs->trim[i][1];
+			fs->trim[i][1] = start - 1;
+			if (fs->n_trim < FF_TRIM_BATCH) {	/* Split it in two */
+				fs->trim[fs->n_trim][0] = rt[0]; fs->trim[fs->n_trim][1] = rt[1];
+				fs->n_trim++;
+			} else {							/* Discard the tail now if the set is full */
+				disk_ioctl(fs->pdrv, CTRL_TRIM, rt);
+			}
+		}
+	}
+}
+#endif
+/* --- END LIBSLIM PATCH: FEAT_TRIM_BATCH --- */
+
+
 /*-----------------------------------------------------------------------*/
 /* Move/Flush disk access window in the filesystem object                */
 /*-----------------------------------------------------------------------*/
@@ -1111,7 +1305,13 @@ static FRESULT sync_window (	/* Returns FR_OK or FR_DISK_ERR */
 		if (disk_write(fs->pdrv, fs->win, fs->winsect, 1) == RES_OK) {	/* Write it back into the volume */
 			fs->wflag = 0;	/* Clear window dirty flag */
 			if (fs->winsect - fs->fatbase < fs->fsize) {	/* Is it in the 1st FAT? */
+/* --- BEGIN LIBSLIM PATCH: FEAT_FAT_MIRROR --- */
+#if FF_FAT_MIRROR_DEFER
+				if (fs->n_fats == 2) res = defer_mirror(fs, (DWORD)(fs->winsect - fs->fatbase));	/* Reflect it to 2nd FAT later */
+#else
 				if (fs->n_fats == 2) disk_write(fs->pdrv, fs->win, fs->winsect + fs->fsize, 1);	/* Reflect it to 2nd FAT if needed */
+#endif
+/* --- END LIBSLIM PATCH: FEAT_FAT_MIRROR --- */
 			}
 		} else {
 			res = FR_DISK_ERR;
@@ -1161,6 +1361,11 @@ static FRESULT sync_fs (	/* Returns FR_OK or FR_DISK_ERR */
 
 
 	res = sync_window(fs);
+/* --- BEGIN LIBSLIM PATCH: FEAT_FAT_MIRROR --- */
+#if FF_FAT_MIRROR_DEFER
+	if (res == FR_OK) res = flush_mirror(fs);	/* Reflect pending sectors to the 2nd FAT */
+#endif
+/* --- END LIBSLIM PATCH: FEAT_FAT_MIRROR --- */
 	if (res == FR_OK) {
 		if (fs->fs_type == FS_FAT32 && fs->fsi_flag == 1) {	/* FAT32: Update FSInfo sector if needed */
 			/* Create FSInfo structure */
@@ -1178,6 +1383,11 @@ static FRESULT sync_fs (	/* Returns FR_OK or FR_DISK_ERR */
 		/* Make sure that no pending write process in the lower layer */
 		if (disk_ioctl(fs->pdrv, CTRL_SYNC, 0) != RES_OK) res = FR_DISK_ERR;
 	}
+/* --- BEGIN LIBSLIM PATCH: FEAT_TRIM_BATCH --- */
+#if FF_USE_TRIM && FF_TRIM_BATCH
+	if (res == FR_OK) flush_trim(fs);	/* Discard the freed blocks once the FAT no longer refers to them */
+#endif
+/* --- END LIBSLIM PATCH: FEAT_TRIM_BATCH --- */
 
 	return res;
 }
@@ -1525,7 +1735,13 @@ static FRESULT remove_chain (	/* FR_OK(0):succeeded, !=0:error */
 #if FF_USE_TRIM
 			rt[0] = clst2sect(fs, scl);					/* Start of data area to be freed */
 			rt[1] = clst2sect(fs, ecl) + fs->csize - 1;	/* End of data area to be freed */
+/* --- BEGIN LIBSLIM PATCH: FEAT_TRIM_BATCH --- */
+#if FF_TRIM_BATCH
+			defer_trim(fs, rt[0], rt[1]);				/* Discard the block when the volume is synced */
+#else
 			disk_ioctl(fs->pdrv, CTRL_TRIM, rt);		/* Inform storage device that the data in the block may be erased */
+#endif
+/* --- END LIBSLIM PATCH: FEAT_TRIM_BATCH --- */
 #endif
 			scl = ecl = nxt;
 		}
@@ -1655,6 +1871,11 @@ static DWORD create_chain (	/* 0:No free cluster, 1:Internal error, 0xFFFFFFFF:D
 		fs->last_clst = ncl;
 		if (fs->free_clst <= fs->n_fatent - 2) fs->free_clst--;
 		fs->fsi_flag |= 1;
+/* --- BEGIN LIBSLIM PATCH: FEAT_TRIM_BATCH --- */
+#if FF_USE_TRIM && FF_TRIM_BATCH
+		if (fs->n_trim) cancel_trim(fs, clst2sect(fs, ncl), clst2sect(fs, ncl) + fs->csize - 1);	/* Do not discard the new cluster */
+#endif
+/* --- END LIBSLIM PATCH: FEAT_TRIM_BATCH --- */
 	} else {
 		ncl = (res == FR_DISK_ERR) ? 0xFFFFFFFF : 1;	/* Failed. Generate error status */
 	}
@@ -1662,6 +1883,87 @@ static DWORD create_chain (	/* 0:No free cluster, 1:Internal error, 0xFFFFFFFF:D
 	return ncl;		/* Return new cluster number or error status */
 }
 
+
+
+/* --- BEGIN LIBSLIM PATCH: FEAT_MULTI_CLUSTER --- */
+/*-----------------------------------------------------------------------*/
+/* FAT handling - Stretch a chain with a run of contiguous clusters      */
+/*-----------------------------------------------------------------------*/
+
+static FRESULT stretch_chain (	/* FR_OK(0):succeeded, !=0:error */
+	FFOBJID* obj,		/* Corresponding object */
+	DWORD clst,			/* Cluster# to stretch, the chain is not stretched if it is not the last one */
+	DWORD max,			/* Maximum number of clusters to allocate */
+	DWORD* ncl			/* Pointer to the variable to return number of clusters allocated next to clst */
+)
+{
+	DWORD cs, n;
+	FRESULT res;
+	FATFS *fs = obj->fs;
+
+
+	*ncl = 0;
+#if FF_FS_EXFAT
+	if (fs->fs_type == FS_EXFAT && obj->stat == 2) {	/* Contiguous chain has no FAT, its end is given by the object size */
+		if (obj->objsize != 0 && clst - obj->sclust < (DWORD)((obj->objsize - 1) / SS(fs) / fs->csize)) return FR_OK;
+	} else
+#endif
+	{
+		cs = get_fat(obj, clst);			/* Check the cluster status */
+		if (cs < 2) return FR_INT_ERR;
+		if (cs == 0xFFFFFFFF) return FR_DISK_ERR;
+		if (cs < fs->n_fatent) return FR_OK;	/* It is already followed by next cluster */
+	}
+	if (fs->free_clst == 0) return FR_OK;	/* No free cluster */
+
+#if FF_FS_EXFAT
+	if (fs->fs_type == FS_EXFAT) {	/* On the exFAT volume */
+		for (n = 0; n < max && clst + n + 1 < fs->n_fatent; n++) {	/* Count free clusters next to the chain */
+			cs = clst + n + 1 - 2;			/* Bit offset in the allocation bitmap */
+			if (move_window(fs, fs->bitbase + cs / 8 / SS(fs)) != FR_OK) return FR_DISK_ERR;
+			if (fs->win[cs / 8 % SS(fs)] & (1 << (cs % 8))) break;	/* In use? */
+		}
+		if (n == 0) return FR_OK;
+		if (obj->stat == 2) {	/* Contiguous chain: mark the run 'in use' at once */
+			res = change_bitmap(fs, clst + 1, n, 1);
+			if (res != FR_OK) return res;
+			fs->last_clst = clst + n;
+			if (fs->free_clst <= fs->n_fatent - 2) fs->free_clst = (fs->free_clst > n) ? fs->free_clst - n : 0;
+			fs->fsi_flag |= 1;
+		} else {				/* Fragmented chain: let create_chain() track the last fragment */
+			for (cs = 0; cs < n; cs++) {
+				if (create_chain(obj, clst + cs) != clst + cs + 1) return FR_INT_ERR;
+			}
+		}
+	} else
+#endif
+	{	/* On the FAT/FAT32 volume */
+		for (n = 0; n < max && clst + n + 1 < fs->n_fatent; n++) {	/* Count free clusters next to the chain */
+			cs = get_fat(obj, clst + n + 1);
+			if (cs == 1) return FR_INT_ERR;
+			if (cs == 0xFFFFFFFF) return FR_DISK_ERR;
+			if (cs != 0) break;				/* In use? */
+		}
+		if (n == 0) return FR_OK;
+		for (cs = clst + 1; cs < clst + n; cs++) {	/* Link the run in one pass */
+			res = put_fat(fs, cs, cs + 1);
+			if (res != FR_OK) return res;
+		}
+		res = put_fat(fs, clst + n, 0xFFFFFFFF);	/* Mark the last cluster 'EOC' */
+		if (res == FR_OK) res = put_fat(fs, clst, clst + 1);	/* Link the run from the chain */
+		if (res != FR_OK) return res;
+		fs->last_clst = clst + n;
+		if (fs->free_clst <= fs->n_fatent - 2) fs->free_clst = (fs->free_clst > n) ? fs->free_clst - n : 0;
+		fs->fsi_flag |= 1;
+	}
+#if FF_USE_TRIM && FF_TRIM_BATCH
+	if (fs->n_trim) cancel_trim(fs, clst2sect(fs, clst + 1), clst2sect(fs, clst + n) + fs->csize - 1);	/* Do not discard the new clusters */
+#endif
+	*ncl = n;
+	return FR_OK;
+}
+/* --- END LIBSLIM PATCH: FEAT_MULTI_CLUSTER --- */
+
 #endif /* !FF_FS_READONLY */
 
 
@@ -1697,6 +1999,46 @@ static DWORD clmt_clust (	/* <2:Error, >=2:Cluster number */
 
 
 
+/* --- BEGIN LIBSLIM PATCH: FEAT_MULTI_CLUSTER --- */
+/*-----------------------------------------------------------------------*/
+/* FAT handling - Count clusters contiguous to a cluster of a file       */
+/*-----------------------------------------------------------------------*/
+
+static DWORD contig_clust (	/* Number of clusters following clst contiguously (0..max) */
+	FIL* fp,		/* Pointer to the file object */
+	DWORD clst,		/* Cluster at the file offset */
+	FSIZE_t ofs,	/* File offset in the cluster */
+	DWORD max		/* Maximum number of clusters to look ahead */
+)
+{
+	DWORD n, nxt;
+
+
+#if FF_USE_FASTSEEK
+	if (fp->cltbl) {	/* Get the rest of the fragment from the CLMT */
+		FATFS *fs = fp->obj.fs;
+		DWORD *tbl = fp->cltbl + 1;
+
+		n = (DWORD)(ofs / SS(fs) / fs->csize);	/* Cluster order from top of the file */
+		while (*tbl && n >= *tbl) {
+			n -= *tbl; tbl += 2;
+		}
+		if (*tbl == 0) return 0;
+		n = *tbl - n - 1;	/* Clusters following clst in the fragment */
+		return (n < max) ? n : max;
+	}
+#endif
+	for (n = 0; n < max; n++) {	/* Follow the chain on the FAT while it is contiguous */
+		nxt = get_fat(&fp->obj, clst + n);
+		if (nxt != clst + n + 1) break;	/* Fragmented, end of the chain or error */
+	}
+	return n;
+}
+/* --- END LIBSLIM PATCH: FEAT_MULTI_CLUSTER --- */
+
+
+
+
 /*-----------------------------------------------------------------------*/
 /* Directory handling - Fill a cluster with zeros                        */
 /*-----------------------------------------------------------------------*/
@@ -2207,6 +2549,9 @@ static void get_xfileinfo (
 	fno->fsize = (fno->fattrib & AM_DIR) ? 0 : ld_qword(dirb + XDIR_FileSize);	/* Size */
 	fno->ftime = ld_word(dirb + XDIR_ModTime + 0);	/* Time */
 	fno->fdate = ld_word(dirb + XDIR_ModTime + 2);	/* Date */
+/* --- BEGIN LIBSLIM PATCH: FEAT_STAT_FCLUST --- */
+	fno->fclust = ld_dword(dirb + XDIR_FstClus);	/* Cluster */
+/* --- END LIBSLIM PATCH: FEAT_STAT_FCLUST --- */
 }
 
 #endif	/* FF_FS_MINIMIZE <= 1 || FF_FS_RPATH >= 2 */
@@ -2482,6 +2827,262 @@ static FRESULT dir_read (
 
 
 
+/* --- BEGIN LIBSLIM PATCH: FEAT_DIR_INDEX --- */
+#if FF_USE_DIR_INDEX
+/*-----------------------------------------------------------------------*/
+/* Directory handling - Name index of FAT directories                    */
+/*-----------------------------------------------------------------------*/
+/* A name hash is the sum of a mixed term for each character and its
+/  position, so the LFN entries can be hashed in the order they appear on
+/  the disk, which is the reverse of the order of the name parts. */
+
+static DWORD dix_term (	/* Returns the hash term of a character */
+	DWORD pos,			/* Position of the character in the name */
+	DWORD chr			/* Up-cased character */
+)
+{
+	DWORD h = (pos << 16 | chr) * 0x9E3779B1;
+
+	h ^= h >> 15;
+	h *= 0x85EBCA77;
+	return h ^ (h >> 13);
+}
+
+
+static WORD dix_final (	/* Returns the name hash to be stored in the index */
+	DWORD sum,			/* Sum of the hash terms */
+	UINT len			/* Length of the name */
+)
+{
+	sum += dix_term(0xFFFF, len);
+	sum *= 0x9E3779B1;
+	return (WORD)(sum >> 16);
+}
+
+
+static WORD dix_hash_lfn (	/* Returns the name hash of an LFN */
+	const WCHAR* lfn		/* Pointer to the LFN */
+)
+{
+	DWORD sum = 0;
+	UINT i;
+
+	for (i = 0; lfn[i]; i++) sum += dix_term(i, ff_wtoupper(lfn[i]));
+	return dix_final(sum, i);
+}
+
+
+static WORD dix_hash_sfn (	/* Returns the name hash of an SFN */
+	const BYTE* sfn			/* Pointer to the SFN in directory form */
+)
+{
+	DWORD sum = 0;
+	UINT i;
+
+	for (i = 0; i < 11; i++) sum += dix_term(i, sfn[i]);
+	return dix_final(sum, 0x100);	/* An LFN can not have this length */
+}
+
+
+static FRESULT dir_index_build (	/* FR_OK(0):succeeded, !=0:error */
+	DIR* dp,						/* Directory object to be indexed */
+	DIRINDEX** pidx					/* Pointer to return the index (null when over the budget) */
+)
+{
+	FRESULT res = FR_OK;
+	FATFS *fs = dp->obj.fs;
+	DIRINDEX *idx = 0;
+	DWORD lsum = 0, blk = 0;
+	UINT i, s, len = 0, n = 0, pass;
+	BYTE c, a, ord = 0xFF, sum = 0xFF;
+	WCHAR wc;
+
+
+	*pidx = 0;
+	if (dirindex_excluded(fs, dp->obj.sclust)) return FR_OK;	/* Known not to fit in an index */
+	for (pass = 0; pass < 2 && res == FR_OK; pass++) {	/* Count the names, and then index them */
+		if (pass == 1) {
+			*pidx = idx = dirindex_create(fs, dp->obj.sclust, n);
+			if (!idx) return FR_OK;
+		}
+		ord = 0xFF;
+		res = dir_sdi(dp, 0);
+		while (res == FR_OK) {
+			res = move_window(fs, dp->sect);
+			if (res != FR_OK) break;
+			c = dp->dir[DIR_Name];
+			if (c == 0) { res = FR_NO_FILE; break; }	/* Reached to end of table */
+			a = dp->dir[DIR_Attr] & AM_MASK;
+			if (c == DDEM || ((a & AM_VOL) && a != AM_LFN)) {	/* An entry without valid data */
+				ord = 0xFF;
+			} else if (a == AM_LFN) {	/* An LFN entry is found */
+				if (c & LLEF) {			/* Start of an LFN sequence */
+					sum = dp->dir[LDIR_Chksum];
+					c &= (BYTE)~LLEF; ord = c;
+					blk = dp->dptr; lsum = 0; len = c * 13;
+				}
+				if (c == ord && sum == dp->dir[LDIR_Chksum] && ld_word(dp->dir + LDIR_FstClusLO) == 0) {
+					i = ((c & 0x3F) - 1) * 13;
+					for (s = 0; pass == 1 && s < 13; s++, i++) {	/* Hash in the part of the LFN */
+						wc = ld_word(dp->dir + LfnOfs[s]);
+						if (wc == 0) {
+							if (i < len) len = i;
+							break;
+						}
+						lsum += dix_term(i, ff_wtoupper(wc));
+					}
+					ord--;
+				} else {
+					ord = 0xFF;
+				}
+			} else {					/* An SFN entry is found */
+				if (ord == 0 && sum == sum_sfn(dp->dir)) {	/* Valid LFN? */
+					if (pass == 0) {
+						n++;
+					} else if (!dirindex_insert(idx, dix_final(lsum, len), blk / SZDIRE)) {
+						*pidx = 0; break;
+					}
+				} else {
+					blk = dp->dptr;
+				}
+				if (pass == 0) {
+					if (blk / SZDIRE > DIRINDEX_MAX_OFS) {	/* Entries past the index range */
+						dirindex_exclude(fs, dp->obj.sclust);
+						return FR_OK;
+					}
+					n++;
+				} else if (!dirindex_insert(idx, dix_hash_sfn(dp->dir), blk / SZDIRE)) {
+					*pidx = 0; break;
+				}
+				ord = 0xFF;
+			}
+			res = dir_next(dp, 0);	/* Next entry */
+		}
+		if (res == FR_NO_FILE) res = FR_OK;	/* The whole table has been read */
+	}
+	if (res != FR_OK && *pidx) {
+		dirindex_drop(fs, dp->obj.sclust);
+		*pidx = 0;
+	}
+	return res;
+}
+
+
+static FRESULT dir_find_block (	/* FR_OK:matched, FR_NO_FILE:not matched, FR_INVALID_OBJECT:index is stale */
+	DIR* dp						/* Directory object pointing the top of the entry block */
+)
+{
+	FRESULT res;
+	FATFS *fs = dp->obj.fs;
+	BYTE c, a, ord = 0xFF, sum = 0xFF;
+
+
+	dp->blk_ofs = 0xFFFFFFFF;
+	do {
+		res = move_window(fs, dp->sect);
+		if (res != FR_OK) break;
+		c = dp->dir[DIR_Name];
+		dp->obj.attr = a = dp->dir[DIR_Attr] & AM_MASK;
+		if (c == 0 || c == DDEM || ((a & AM_VOL) && a != AM_LFN)) {	/* The block is not there any more */
+			res = FR_INVALID_OBJECT; break;
+		}
+		if (a == AM_LFN) {			/* An LFN entry is found */
+			if (!(dp->fn[NSFLAG] & NS_NOLFN)) {
+				if (c & LLEF) {		/* Is it start of LFN sequence? */
+					sum = dp->dir[LDIR_Chksum];
+					c &= (BYTE)~LLEF; ord = c;	/* LFN start order */
+					dp->blk_ofs = dp->dptr;	/* Start offset of LFN */
+				}
+				/* Check validity of the LFN entry and compare it with given name */
+				ord = (c == ord && sum == dp->dir[LDIR_Chksum] && cmp_lfn(fs->lfnbuf, dp->dir)) ? ord - 1 : 0xFF;
+			}
+		} else {					/* An SFN entry ends the block */
+			if (ord == 0 && sum == sum_sfn(dp->dir)) break;	/* LFN matched? */
+			if (!(dp->fn[NSFLAG] & NS_LOSS) && !mem_cmp(dp->dir, dp->fn, 11)) break;	/* SFN matched? */
+			dp->blk_ofs = 0xFFFFFFFF;
+			res = FR_NO_FILE; break;
+		}
+		res = dir_next(dp, 0);	/* Next entry */
+		if (res == FR_NO_FILE) res = FR_INVALID_OBJECT;	/* The table ended in the block */
+	} while (res == FR_OK);
+
+	return res;
+}
+
+
+static int dir_find_indexed (	/* 1:searched with the index, 0:the directory needs to be searched linearly */
+	DIR* dp,					/* Pointer to the directory object with the file name */
+	FRESULT* rp					/* Pointer to return the result of the search */
+)
+{
+	FATFS *fs = dp->obj.fs;
+	DIRINDEX *idx;
+	DWORD ofs;
+	UINT iter, k;
+	WORD hash;
+	FRESULT res;
+
+
+	idx = dirindex_get(fs, dp->obj.sclust);
+	if (!idx) {				/* Index the directory on first lookup */
+		res = dir_index_build(dp, &idx);
+		if (res != FR_OK) { *rp = res; return 1; }
+	}
+	if (idx) {
+		res = FR_OK;
+		for (k = 0; k < 2; k++) {	/* Look up the LFN and then the SFN */
+			if (k == 0) {
+				if (dp->fn[NSFLAG] & NS_NOLFN) continue;
+				hash = dix_hash_lfn(fs->lfnbuf);
+			} else {
+				if (dp->fn[NSFLAG] & NS_LOSS) continue;
+				hash = dix_hash_sfn(dp->fn);
+			}
+			iter = 0;
+			while ((ofs = dirindex_find(idx, hash, &iter)) != DIRINDEX_NONE) {
+				res = dir_sdi(dp, ofs * SZDIRE);
+				if (res == FR_OK) res = dir_find_block(dp);
+				if (res == FR_NO_FILE) continue;
+				if (res == FR_INVALID_OBJECT) {	/* The index is out of date, discard it */
+					dirindex_drop(fs, dp->obj.sclust);
+					break;
+				}
+				*rp = res;
+				return 1;
+			}
+			if (res == FR_INVALID_OBJECT) break;
+		}
+		if (k == 2) {		/* Every candidate has been rejected */
+			dp->blk_ofs = 0xFFFFFFFF;
+			*rp = FR_NO_FILE;
+			return 1;
+		}
+	}
+	res = dir_sdi(dp, 0);	/* Rewind directory object for the linear search */
+	if (res != FR_OK) { *rp = res; return 1; }
+	return 0;
+}
+
+
+static void dir_index_add (
+	DIR* dp,				/* Directory object pointing the SFN entry of a new object */
+	DWORD blk				/* Offset of the top of the entry block */
+)
+{
+	FATFS *fs = dp->obj.fs;
+	DIRINDEX *idx = dirindex_get(fs, dp->obj.sclust);
+
+
+	if (!idx) return;
+	if (blk != dp->dptr && !dirindex_insert(idx, dix_hash_lfn(fs->lfnbuf), blk / SZDIRE)) return;
+	dirindex_insert(idx, dix_hash_sfn(dp->fn), blk / SZDIRE);
+}
+#endif
+/* --- END LIBSLIM PATCH: FEAT_DIR_INDEX --- */
+
+
+
+
 /*-----------------------------------------------------------------------*/
 /* Directory handling - Find an object in the directory                  */
 /*-----------------------------------------------------------------------*/
@@ -2520,6 +3121,11 @@ static FRESULT dir_find (	/* FR_OK(0):succeeded, !=0:error */
 	}
 #endif
 	/* On the FAT/FAT32 volume */
+/* --- BEGIN LIBSLIM PATCH: FEAT_DIR_INDEX --- */
+#if FF_USE_DIR_INDEX
+	if (dir_find_indexed(dp, &res)) return res;
+#endif
+/* --- END LIBSLIM PATCH: FEAT_DIR_INDEX --- */
 #if FF_USE_LFN
 	ord = sum = 0xFF; dp->blk_ofs = 0xFFFFFFFF;	/* Reset LFN sequence */
 #endif
@@ -2580,6 +3186,11 @@ static FRESULT dir_register (	/* FR_OK:succeeded, FR_DENIED:no free entry or too
 
 	if (dp->fn[NSFLAG] & (NS_DOT | NS_NONAME)) return FR_INVALID_NAME;	/* Check name validity */
 	for (nlen = 0; fs->lfnbuf[nlen]; nlen++) ;	/* Get lfn length */
+/* --- BEGIN LIBSLIM PATCH: FEAT_NEG_CACHE --- */
+#if FF_USE_NEG_CACHE
+	negcache_drop(fs, dp->obj.sclust);	/* Missing names may be created in this directory */
+#endif
+/* --- END LIBSLIM PATCH: FEAT_NEG_CACHE --- */
 
 #if FF_FS_EXFAT
 	if (fs->fs_type == FS_EXFAT) {	/* On the exFAT volume */
@@ -2658,6 +3269,12 @@ static FRESULT dir_register (	/* FR_OK:succeeded, FR_DENIED:no free entry or too
 			dp->dir[DIR_NTres] = dp->fn[NSFLAG] & (NS_BODY | NS_EXT);	/* Put NT flag */
 #endif
 			fs->wflag = 1;
+/* --- BEGIN LIBSLIM PATCH: FEAT_DIR_INDEX --- */
+#if FF_USE_DIR_INDEX
+			nent = (sn[NSFLAG] & NS_LFN) ? (nlen + 12) / 13 + 1 : 1;
+			dir_index_add(dp, dp->dptr - (nent - 1) * SZDIRE);
+#endif
+/* --- END LIBSLIM PATCH: FEAT_DIR_INDEX --- */
 		}
 	}
 
@@ -2681,6 +3298,16 @@ static FRESULT dir_remove (	/* FR_OK:Succeeded, FR_DISK_ERR:A disk error */
 	FATFS *fs = dp->obj.fs;
 #if FF_USE_LFN		/* LFN configuration */
 	DWORD last = dp->dptr;
+/* --- BEGIN LIBSLIM PATCH: FEAT_DIR_INDEX --- */
+#if FF_USE_DIR_INDEX
+	DIRINDEX *idx = dirindex_get(fs, dp->obj.sclust);
+
+	if (idx) {
+		dirindex_remove(idx, last / SZDIRE);
+		if (dp->blk_ofs != 0xFFFFFFFF) dirindex_remove(idx, dp->blk_ofs / SZDIRE);
+	}
+#endif
+/* --- END LIBSLIM PATCH: FEAT_DIR_INDEX --- */
 
 	res = (dp->blk_ofs == 0xFFFFFFFF) ? FR_OK : dir_sdi(dp, dp->blk_ofs);	/* Goto top of the entry block if LFN is exist */
 	if (res == FR_OK) {
@@ -2946,6 +3573,9 @@ static FRESULT create_name (	/* FR_OK: successful, FR_INVALID_NAME: could not cr
 	} else {
 		cf = 0;					/* Next segment follows */
 		while (*p == '/' || *p == '\\') p++;	/* Skip duplicated separators if exist */
+/* --- BEGIN LIBSLIM PATCH: FEAT_TRAILING_SEP --- */
+		if ((UINT)*p < ' ') cf = NS_LAST;	/* Ignore terminating separator (as in R0.15) */
+/* --- END LIBSLIM PATCH: FEAT_TRAILING_SEP --- */
 	}
 	*path = p;					/* Return pointer to the next segment */
 
@@ -3102,6 +3732,9 @@ static FRESULT create_name (	/* FR_OK: successful, FR_INVALID_NAME: could not cr
 	}
 	*path = p + si;						/* Return pointer to the next segment */
 	if (i == 0) return FR_INVALID_NAME;	/* Reject nul string */
+/* --- BEGIN LIBSLIM PATCH: FEAT_TRAILING_SEP --- */
+	if ((BYTE)p[si] <= ' ') c = 0;		/* Ignore terminating separator (as in R0.15) */
+/* --- END LIBSLIM PATCH: FEAT_TRAILING_SEP --- */
 
 	if (sfn[0] == DDEM) sfn[0] = RDDEM;	/* If the first character collides with DDEM, replace it with RDDEM */
 	sfn[NSFLAG] = (c <= ' ') ? NS_LAST : 0;		/* Set last segment flag if end of the path */
@@ -3125,6 +3758,14 @@ static FRESULT follow_path (	/* FR_OK(0): successful, !=0: error code */
 	FRESULT res;
 	BYTE ns;
 	FATFS *fs = dp->obj.fs;
+/* --- BEGIN LIBSLIM PATCH: FEAT_PATH_CACHE --- */
+#if FF_USE_PATH_CACHE
+	const TCHAR *top;
+	DWORD base;
+	PATHCACHE_DIR pcd;
+	UINT plen;
+#endif
+/* --- END LIBSLIM PATCH: FEAT_PATH_CACHE --- */
 
 
 #if FF_FS_RPATH != 0
@@ -3152,6 +3793,29 @@ static FRESULT follow_path (	/* FR_OK(0): successful, !=0: error code */
 	}
 #endif
 #endif
+/* --- BEGIN LIBSLIM PATCH: FEAT_PATH_CACHE --- */
+#if FF_USE_PATH_CACHE
+	top = path; base = dp->obj.sclust;
+	plen = pathcache_lookup(fs, base, path, &pcd);	/* Skip the directories of a cached prefix */
+	if (plen) {
+		path += plen;
+		dp->obj.sclust = pcd.sclust;
+#if FF_FS_EXFAT
+		if (fs->fs_type == FS_EXFAT) {	/* exFAT: Retrieve the sub-directory's status */
+			DIR dj;
+
+			dp->obj.c_scl = pcd.c_scl;
+			dp->obj.c_size = pcd.c_size;
+			dp->obj.c_ofs = pcd.c_ofs;
+			res = load_obj_xdir(&dj, &dp->obj);
+			if (res != FR_OK) return res;
+			dp->obj.objsize = ld_dword(fs->dirbuf + XDIR_FileSize);
+			dp->obj.stat = fs->dirbuf[XDIR_GenFlags] & 2;
+		}
+#endif
+	}
+#endif
+/* --- END LIBSLIM PATCH: FEAT_PATH_CACHE --- */
 
 	if ((UINT)*path < ' ') {				/* Null path name is the origin directory itself */
 		dp->fn[NSFLAG] = NS_NONAME;
@@ -3161,7 +3825,24 @@ static FRESULT follow_path (	/* FR_OK(0): successful, !=0: error code */
 		for (;;) {
 			res = create_name(dp, &path);	/* Get a segment name of the path */
 			if (res != FR_OK) break;
+/* --- BEGIN LIBSLIM PATCH: FEAT_PATH_CACHE --- */
+#if FF_USE_PATH_CACHE
+			if (dp->fn[NSFLAG] & NS_DOT) top = 0;	/* Do not cache prefixes with dot entries */
+#endif
+/* --- END LIBSLIM PATCH: FEAT_PATH_CACHE --- */
+/* --- BEGIN LIBSLIM PATCH: FEAT_NEG_CACHE --- */
+#if FF_USE_NEG_CACHE
+			if (!(dp->fn[NSFLAG] & NS_DOT) && negcache_lookup(fs, dp->obj.sclust, fs->lfnbuf)) {
+				dp->blk_ofs = 0xFFFFFFFF;
+				res = FR_NO_FILE;			/* The object is known to be missing */
+			} else {
+				res = dir_find(dp);			/* Find an object with the segment name */
+				if (res == FR_NO_FILE && !(dp->fn[NSFLAG] & NS_DOT)) negcache_store(fs, dp->obj.sclust, fs->lfnbuf);
+			}
+#else
 			res = dir_find(dp);				/* Find an object with the segment name */
+#endif
+/* --- END LIBSLIM PATCH: FEAT_NEG_CACHE --- */
 			ns = dp->fn[NSFLAG];
 			if (res != FR_OK) {				/* Failed to find the object */
 				if (res == FR_NO_FILE) {	/* Object is not found */
@@ -3191,6 +3872,19 @@ static FRESULT follow_path (	/* FR_OK(0): successful, !=0: error code */
 			{
 				dp->obj.sclust = ld_clust(fs, fs->win + dp->dptr % SS(fs));	/* Open next directory */
 			}
+/* --- BEGIN LIBSLIM PATCH: FEAT_PATH_CACHE --- */
+#if FF_USE_PATH_CACHE
+			if (top) {						/* Cache the prefix up to this directory */
+				pcd.sclust = dp->obj.sclust;
+#if FF_FS_EXFAT
+				pcd.c_scl = dp->obj.c_scl;
+				pcd.c_size = dp->obj.c_size;
+				pcd.c_ofs = dp->obj.c_ofs;
+#endif
+				pathcache_store(fs, base, top, (UINT)(path - top), &pcd);
+			}
+#endif
+/* --- END LIBSLIM PATCH: FEAT_PATH_CACHE --- */
 		}
 	}
 
@@ -3218,6 +3912,12 @@ int get_ldnumber (	/* Returns logical drive number (-1:invalid drive number or n
 
 	tt = tp = *path;
 	if (!tp) return vol;	/* Invalid path name? */
+/* --- BEGIN LIBSLIM PATCH: FEAT_VOL_PREFIX --- */
+#if VOL_PREFIX_TABLE
+	i = get_vol_prefix(tp, path);	/* Match the volume ID without searching for a colon */
+	if (i >= 0) return i;
+#endif
+/* --- END LIBSLIM PATCH: FEAT_VOL_PREFIX --- */
 	do tc = *tt++; while ((UINT)tc >= (FF_USE_LFN ? ' ' : '!') && tc != ':');	/* Find a colon in the path */
 
 	if (tc == ':') {	/* DOS/Windows style volume ID? */
@@ -3423,6 +4123,89 @@ static UINT find_volume (	/* Returns BS status found in the hosting drive */
 
 
 
+/* --- BEGIN LIBSLIM PATCH: FEAT_PINNED_BUF --- */
+#if !FF_FS_TINY
+#if FF_PINNED_FILE_BUF
+/*-----------------------------------------------------------------------*/
+/* Move the file data window to a pinned sector cache block              */
+/*-----------------------------------------------------------------------*/
+
+static FRESULT load_filebuf (	/* FR_OK(0):succeeded, !=0:error */
+	FIL* fp,		/* Pointer to the file object (window must be clean) */
+	LBA_t sect,		/* Sector to appear in the window */
+	BYTE load		/* 1:Read the sector, 0:The sector is going to be overwritten */
+)
+{
+	FATFS *fs = fp->obj.fs;
+	BYTE *buf;
+
+
+	buf = disk_pin(fs->pdrv, sect, load);
+	if (!buf) return FR_DISK_ERR;
+	if (fp->buf) {
+		disk_unpin(fs->pdrv, fp->buf);	/* Release the previous window */
+	} else {
+		fp->pin_next = fs->pinned;		/* Register the file to the volume */
+		fs->pinned = fp;
+	}
+	fp->buf = buf;
+	return FR_OK;
+}
+
+
+
+/*-----------------------------------------------------------------------*/
+/* Release the pinned window of a file object                            */
+/*-----------------------------------------------------------------------*/
+
+static void release_filebuf (
+	FATFS* fs,		/* Filesystem object the file is registered to */
+	FIL* fp			/* Pointer to the file object */
+)
+{
+	FIL **pp;
+
+
+	if (!fp->buf) return;
+	for (pp = &fs->pinned; *pp; pp = &(*pp)->pin_next) {	/* Unregister the file from the volume */
+		if (*pp == fp) {
+			*pp = fp->pin_next;
+			break;
+		}
+	}
+	disk_unpin(fs->pdrv, fp->buf);
+	fp->buf = 0;
+}
+
+
+
+/*-----------------------------------------------------------------------*/
+/* Release the pinned windows of every file object on a volume           */
+/*-----------------------------------------------------------------------*/
+
+static void release_filebufs (
+	FATFS* fs		/* Filesystem object to be unmounted */
+)
+{
+	FIL *fp;
+
+
+	for (fp = fs->pinned; fp; fp = fp->pin_next) {	/* The file objects are invalidated with the volume */
+		disk_unpin(fs->pdrv, fp->buf);
+		fp->buf = 0;
+	}
+	fs->pinned = 0;
+}
+#else
+#define load_filebuf(fp, sect, load) \
+	(disk_read((fp)->obj.fs->pdrv, (fp)->buf, sect, 1) == RES_OK ? FR_OK : FR_DISK_ERR)
+#endif
+#endif
+/* --- END LIBSLIM PATCH: FEAT_PINNED_BUF --- */
+
+
+
+
 /*-----------------------------------------------------------------------*/
 /* Determine logical drive number and mount the volume if needed         */
 /*-----------------------------------------------------------------------*/
@@ -3469,7 +4252,22 @@ static FRESULT mount_volume (	/* FR_OK(0): successful, !=0: an error occurred */
 	/* The filesystem object is not valid. */
 	/* Following code attempts to mount the volume. (find a FAT volume, analyze the BPB and initialize the filesystem object) */
 
+/* --- BEGIN LIBSLIM PATCH: FEAT_PINNED_BUF --- */
+#if !FF_FS_TINY && FF_PINNED_FILE_BUF
+	release_filebufs(fs);				/* Files of the previous mount are no longer valid */
+#endif
+/* --- END LIBSLIM PATCH: FEAT_PINNED_BUF --- */
 	fs->fs_type = 0;					/* Clear the filesystem object */
+/* --- BEGIN LIBSLIM PATCH: FEAT_FAT_MIRROR --- */
+#if !FF_FS_READONLY && FF_FAT_MIRROR_DEFER
+	fs->n_mirror = 0;					/* Discard pending 2nd FAT sectors of the previous mount */
+#endif
+/* --- END LIBSLIM PATCH: FEAT_FAT_MIRROR --- */
+/* --- BEGIN LIBSLIM PATCH: FEAT_TRIM_BATCH --- */
+#if !FF_FS_READONLY && FF_USE_TRIM && FF_TRIM_BATCH
+	fs->n_trim = 0;						/* Forget pending discards of the previous mount */
+#endif
+/* --- END LIBSLIM PATCH: FEAT_TRIM_BATCH --- */
 	fs->pdrv = LD2PD(vol);				/* Volume hosting physical drive */
 	stat = disk_initialize(fs->pdrv);	/* Initialize the physical drive */
 	if (stat & STA_NOINIT) { 			/* Check if the initialization succeeded */
@@ -3716,25 +4514,75 @@ FRESULT f_mount (
 	vol = get_ldnumber(&rp);
 	if (vol < 0) return FR_INVALID_DRIVE;
 	cfs = FatFs[vol];					/* Pointer to fs object */
+/* --- BEGIN LIBSLIM PATCH: FEAT_FAT_MIRROR --- */
+#if !FF_FS_READONLY && FF_FAT_MIRROR_DEFER
+	res = FR_OK;
+#endif
+/* --- END LIBSLIM PATCH: FEAT_FAT_MIRROR --- */
 
 	if (cfs) {
 #if FF_FS_LOCK != 0
 		clear_lock(cfs);
 #endif
+/* --- BEGIN LIBSLIM PATCH: FEAT_FAT_MIRROR --- */
+#if !FF_FS_READONLY && FF_FAT_MIRROR_DEFER
+		if (cfs->fs_type) {				/* Reflect pending sectors to the 2nd FAT before unmounting */
+			res = sync_window(cfs);
+			if (res == FR_OK) res = flush_mirror(cfs);
+		}
+#endif
+/* --- END LIBSLIM PATCH: FEAT_FAT_MIRROR --- */
+/* --- BEGIN LIBSLIM PATCH: FEAT_TRIM_BATCH --- */
+#if !FF_FS_READONLY && FF_USE_TRIM && FF_TRIM_BATCH
+		if (cfs->fs_type && cfs->n_trim) {	/* Discard freed blocks only once the FAT is on the disk */
+			if (sync_fs(cfs) != FR_OK) cfs->n_trim = 0;
+		}
+#endif
+/* --- END LIBSLIM PATCH: FEAT_TRIM_BATCH --- */
 #if FF_FS_REENTRANT						/* Discard sync object of the current volume */
 		if (!ff_del_syncobj(cfs->sobj)) return FR_INT_ERR;
 #endif
+/* --- BEGIN LIBSLIM PATCH: FEAT_PINNED_BUF --- */
+#if !FF_FS_TINY && FF_PINNED_FILE_BUF
+		release_filebufs(cfs);			/* Release the windows of the files left open */
+#endif
+/* --- END LIBSLIM PATCH: FEAT_PINNED_BUF --- */
 		cfs->fs_type = 0;				/* Clear old fs object */
+/* --- BEGIN LIBSLIM PATCH: FEAT_DIR_INDEX --- */
+#if FF_USE_DIR_INDEX
+		dirindex_drop_volume(cfs);		/* Discard name indexes of the old volume */
+#endif
+/* --- END LIBSLIM PATCH: FEAT_DIR_INDEX --- */
+/* --- BEGIN LIBSLIM PATCH: FEAT_PATH_CACHE --- */
+#if FF_USE_PATH_CACHE
+		pathcache_drop_volume(cfs);		/* Discard cached paths of the old volume */
+#endif
+/* --- END LIBSLIM PATCH: FEAT_PATH_CACHE --- */
+/* --- BEGIN LIBSLIM PATCH: FEAT_NEG_CACHE --- */
+#if FF_USE_NEG_CACHE
+		negcache_drop_volume(cfs);		/* Discard missing names of the old volume */
+#endif
+/* --- END LIBSLIM PATCH: FEAT_NEG_CACHE --- */
 	}
 
 	if (fs) {
 		fs->fs_type = 0;				/* Clear new fs object */
+/* --- BEGIN LIBSLIM PATCH: FEAT_PINNED_BUF --- */
+#if !FF_FS_TINY && FF_PINNED_FILE_BUF
+		fs->pinned = 0;
+#endif
+/* --- END LIBSLIM PATCH: FEAT_PINNED_BUF --- */
 #if FF_FS_REENTRANT						/* Create sync object for the new volume */
 		if (!ff_cre_syncobj((BYTE)vol, &fs->sobj)) return FR_INT_ERR;
 #endif
 	}
 	FatFs[vol] = fs;					/* Register new fs object */
 
+/* --- BEGIN LIBSLIM PATCH: FEAT_FAT_MIRROR --- */
+#if !FF_FS_READONLY && FF_FAT_MIRROR_DEFER
+	if (res != FR_OK) return res;		/* The old volume was unmounted without its 2nd FAT up to date */
+#endif
+/* --- END LIBSLIM PATCH: FEAT_FAT_MIRROR --- */
 	if (opt == 0) return FR_OK;			/* Do not mount now, it will be mounted later */
 
 	res = mount_volume(&path, &fs, 0);	/* Force mounted the volume */
@@ -3896,9 +4744,18 @@ FRESULT f_open (
 			fp->err = 0;			/* Clear error flag */
 			fp->sect = 0;			/* Invalidate current data sector */
 			fp->fptr = 0;			/* Set file pointer top of the file */
+/* --- BEGIN LIBSLIM PATCH: FEAT_PINNED_BUF --- */
+#if !FF_FS_TINY && FF_PINNED_FILE_BUF
+			fp->buf = 0;			/* No sector buffer until a sector is loaded */
+#endif
+/* --- END LIBSLIM PATCH: FEAT_PINNED_BUF --- */
 #if !FF_FS_READONLY
 #if !FF_FS_TINY
+/* --- BEGIN LIBSLIM PATCH: FEAT_PINNED_BUF --- */
+#if !FF_PINNED_FILE_BUF
 			mem_set(fp->buf, 0, sizeof fp->buf);	/* Clear sector buffer */
+#endif
+/* --- END LIBSLIM PATCH: FEAT_PINNED_BUF --- */
 #endif
 			if ((mode & FA_SEEKEND) && fp->obj.objsize > 0) {	/* Seek to end of file if FA_OPEN_APPEND is specified */
 				fp->fptr = fp->obj.objsize;			/* Offset to seek */
@@ -3916,7 +4773,9 @@ FRESULT f_open (
 					} else {
 						fp->sect = sc + (DWORD)(ofs / SS(fs));
 #if !FF_FS_TINY
-						if (disk_read(fs->pdrv, fp->buf, fp->sect, 1) != RES_OK) res = FR_DISK_ERR;
+/* --- BEGIN LIBSLIM PATCH: FEAT_PINNED_BUF --- */
+						if (load_filebuf(fp, fp->sect, 1) != FR_OK) res = FR_DISK_ERR;
+/* --- END LIBSLIM PATCH: FEAT_PINNED_BUF --- */
 #endif
 					}
 				}
@@ -3964,6 +4823,31 @@ FRESULT f_read (
 
 	for ( ;  btr;								/* Repeat until btr bytes read */
 		btr -= rcnt, *br += rcnt, rbuff += rcnt, fp->fptr += rcnt) {
+/* --- BEGIN LIBSLIM PATCH: FEAT_EXFAT_CONTIG --- */
+#if FF_FS_EXFAT
+		if (fs->fs_type == FS_EXFAT && fp->obj.stat == 2 && fp->fptr % SS(fs) == 0 && btr >= SS(fs)) {	/* Contiguous file without FAT chain? */
+			sect = clst2sect(fs, fp->obj.sclust);	/* Map the file offset to the sector directly */
+			if (sect == 0) ABORT(fs, FR_INT_ERR);
+			sect += (LBA_t)(fp->fptr / SS(fs));
+			cc = btr / SS(fs);					/* Read all whole sectors across cluster boundaries */
+			if (disk_read(fs->pdrv, rbuff, sect, cc) != RES_OK) ABORT(fs, FR_DISK_ERR);
+#if !FF_FS_READONLY && FF_FS_MINIMIZE <= 2
+#if FF_FS_TINY
+			if (fs->wflag && fs->winsect - sect < cc) {
+				mem_cpy(rbuff + ((fs->winsect - sect) * SS(fs)), fs->win, SS(fs));
+			}
+#else
+			if ((fp->flag & FA_DIRTY) && fp->sect - sect < cc) {
+				mem_cpy(rbuff + ((fp->sect - sect) * SS(fs)), fp->buf, SS(fs));
+			}
+#endif
+#endif
+			rcnt = SS(fs) * cc;
+			fp->clust = fp->obj.sclust + (DWORD)((fp->fptr + rcnt - 1) / SS(fs) / fs->csize);	/* Cluster of the last sector read */
+			continue;
+		}
+#endif
+/* --- END LIBSLIM PATCH: FEAT_EXFAT_CONTIG --- */
 		if (fp->fptr % SS(fs) == 0) {			/* On the sector boundary? */
 			csect = (UINT)(fp->fptr / SS(fs) & (fs->csize - 1));	/* Sector offset in the cluster */
 			if (csect == 0) {					/* On the cluster boundary? */
@@ -3989,7 +4873,10 @@ FRESULT f_read (
 			cc = btr / SS(fs);					/* When remaining bytes >= sector size, */
 			if (cc > 0) {						/* Read maximum contiguous sectors directly */
 				if (csect + cc > fs->csize) {	/* Clip at cluster boundary */
-					cc = fs->csize - csect;
+/* --- BEGIN LIBSLIM PATCH: FEAT_MULTI_CLUSTER --- */
+					clst = contig_clust(fp, fp->clust, fp->fptr, (csect + cc - 1) / fs->csize);	/* Extend over the contiguous clusters that follow */
+					if (csect + cc > fs->csize * (clst + 1)) cc = fs->csize * (clst + 1) - csect;
+/* --- END LIBSLIM PATCH: FEAT_MULTI_CLUSTER --- */
 				}
 				if (disk_read(fs->pdrv, rbuff, sect, cc) != RES_OK) ABORT(fs, FR_DISK_ERR);
 #if !FF_FS_READONLY && FF_FS_MINIMIZE <= 2		/* Replace one of the read sectors with cached data if it contains a dirty sector */
@@ -4003,6 +4890,9 @@ FRESULT f_read (
 				}
 #endif
 #endif
+/* --- BEGIN LIBSLIM PATCH: FEAT_MULTI_CLUSTER --- */
+				fp->clust += (csect + cc - 1) / fs->csize;	/* Cluster of the last sector read */
+/* --- END LIBSLIM PATCH: FEAT_MULTI_CLUSTER --- */
 				rcnt = SS(fs) * cc;				/* Number of bytes transferred */
 				continue;
 			}
@@ -4014,7 +4904,9 @@ FRESULT f_read (
 					fp->flag &= (BYTE)~FA_DIRTY;
 				}
 #endif
-				if (disk_read(fs->pdrv, fp->buf, sect, 1) != RES_OK)	ABORT(fs, FR_DISK_ERR);	/* Fill sector cache */
+/* --- BEGIN LIBSLIM PATCH: FEAT_PINNED_BUF --- */
+				if (load_filebuf(fp, sect, 1) != FR_OK)	ABORT(fs, FR_DISK_ERR);	/* Fill sector cache */
+/* --- END LIBSLIM PATCH: FEAT_PINNED_BUF --- */
 			}
 #endif
 			fp->sect = sect;
@@ -4105,7 +4997,20 @@ FRESULT f_write (
 			cc = btw / SS(fs);				/* When remaining bytes >= sector size, */
 			if (cc > 0) {					/* Write maximum contiguous sectors directly */
 				if (csect + cc > fs->csize) {	/* Clip at cluster boundary */
-					cc = fs->csize - csect;
+/* --- BEGIN LIBSLIM PATCH: FEAT_MULTI_CLUSTER --- */
+					DWORD n = (csect + cc - 1) / fs->csize;	/* Number of clusters to be written after the current one */
+
+					clst = contig_clust(fp, fp->clust, fp->fptr, n);	/* Extend over the contiguous clusters that follow */
+#if FF_USE_FASTSEEK
+					if (!fp->cltbl)
+#endif
+					if (clst < n) {	/* Allocate the rest next to the chain if it ends there */
+						res = stretch_chain(&fp->obj, fp->clust + clst, n - clst, &n);
+						if (res != FR_OK) ABORT(fs, res);
+						clst += n;
+					}
+					if (csect + cc > fs->csize * (clst + 1)) cc = fs->csize * (clst + 1) - csect;
+/* --- END LIBSLIM PATCH: FEAT_MULTI_CLUSTER --- */
 				}
 				if (disk_write(fs->pdrv, wbuff, sect, cc) != RES_OK) ABORT(fs, FR_DISK_ERR);
 #if FF_FS_MINIMIZE <= 2
@@ -4121,6 +5026,9 @@ FRESULT f_write (
 				}
 #endif
 #endif
+/* --- BEGIN LIBSLIM PATCH: FEAT_MULTI_CLUSTER --- */
+				fp->clust += (csect + cc - 1) / fs->csize;	/* Cluster of the last sector written */
+/* --- END LIBSLIM PATCH: FEAT_MULTI_CLUSTER --- */
 				wcnt = SS(fs) * cc;		/* Number of bytes transferred */
 				continue;
 			}
@@ -4129,12 +5037,21 @@ FRESULT f_write (
 				if (sync_window(fs) != FR_OK) ABORT(fs, FR_DISK_ERR);
 				fs->winsect = sect;
 			}
+#else
+/* --- BEGIN LIBSLIM PATCH: FEAT_PINNED_BUF --- */
+#if FF_PINNED_FILE_BUF
+			if (fp->sect != sect &&			/* Move the window, filling it with file data if needed */
+				load_filebuf(fp, sect, fp->fptr < fp->obj.objsize) != FR_OK) {
+					ABORT(fs, FR_DISK_ERR);
+			}
 #else
 			if (fp->sect != sect && 		/* Fill sector cache with file data */
 				fp->fptr < fp->obj.objsize &&
 				disk_read(fs->pdrv, fp->buf, sect, 1) != RES_OK) {
 					ABORT(fs, FR_DISK_ERR);
 			}
+#endif
+/* --- END LIBSLIM PATCH: FEAT_PINNED_BUF --- */
 #endif
 			fp->sect = sect;
 		}
@@ -4263,6 +5180,11 @@ FRESULT f_close (
 #else
 			fp->obj.fs = 0;	/* Invalidate file object */
 #endif
+/* --- BEGIN LIBSLIM PATCH: FEAT_PINNED_BUF --- */
+#if !FF_FS_TINY && FF_PINNED_FILE_BUF
+			if (!fp->obj.fs) release_filebuf(fs, fp);	/* Release the sector cache block */
+#endif
+/* --- END LIBSLIM PATCH: FEAT_PINNED_BUF --- */
 #if FF_FS_REENTRANT
 			unlock_fs(fs, FR_OK);		/* Unlock volume */
 #endif
@@ -4273,6 +5195,34 @@ FRESULT f_close (
 
 
 
+/* --- BEGIN LIBSLIM PATCH: FEAT_PINNED_BUF --- */
+#if !FF_FS_TINY && FF_PINNED_FILE_BUF
+/*-----------------------------------------------------------------------*/
+/* Release the Window of a File Discarded without being Closed           */
+/*-----------------------------------------------------------------------*/
+
+void f_unpin (
+	FIL* fp		/* Pointer to the file object that could not be closed */
+)
+{
+	FATFS *fs = fp->obj.fs;
+
+
+	if (!fs || !fp->buf) return;	/* Closed, or the window was released with its volume */
+#if FF_FS_REENTRANT
+	if (!lock_fs(fs)) return;		/* Lock volume */
+#endif
+	release_filebuf(fs, fp);
+	fp->obj.fs = 0;					/* Invalidate file object */
+#if FF_FS_REENTRANT
+	unlock_fs(fs, FR_OK);			/* Unlock volume */
+#endif
+}
+#endif
+/* --- END LIBSLIM PATCH: FEAT_PINNED_BUF --- */
+
+
+
 
 #if FF_FS_RPATH >= 1
 /*-----------------------------------------------------------------------*/
@@ -4525,7 +5475,9 @@ FRESULT f_lseek (
 						fp->flag &= (BYTE)~FA_DIRTY;
 					}
 #endif
-					if (disk_read(fs->pdrv, fp->buf, dsc, 1) != RES_OK) ABORT(fs, FR_DISK_ERR);	/* Load current sector */
+/* --- BEGIN LIBSLIM PATCH: FEAT_PINNED_BUF --- */
+					if (load_filebuf(fp, dsc, 1) != FR_OK) ABORT(fs, FR_DISK_ERR);	/* Load current sector */
+/* --- END LIBSLIM PATCH: FEAT_PINNED_BUF --- */
 #endif
 					fp->sect = dsc;
 				}
@@ -4605,7 +5557,9 @@ FRESULT f_lseek (
 				fp->flag &= (BYTE)~FA_DIRTY;
 			}
 #endif
-			if (disk_read(fs->pdrv, fp->buf, nsect, 1) != RES_OK) ABORT(fs, FR_DISK_ERR);	/* Fill sector cache */
+/* --- BEGIN LIBSLIM PATCH: FEAT_PINNED_BUF --- */
+			if (load_filebuf(fp, nsect, 1) != FR_OK) ABORT(fs, FR_DISK_ERR);	/* Fill sector cache */
+/* --- END LIBSLIM PATCH: FEAT_PINNED_BUF --- */
 #endif
 			fp->sect = nsect;
 		}
@@ -4753,15 +5707,113 @@ FRESULT f_readdir (
 /* Find Next File                                                        */
 /*-----------------------------------------------------------------------*/
 
+/* --- BEGIN LIBSLIM PATCH: FEAT_FIND_EXT --- */
+#if FF_USE_LFN
+/* Gets the extension of a "*.ext" pattern (returns the length of the extension, 0 if not such a pattern) */
+
+static UINT find_ext_pattern (
+	const TCHAR* pat,	/* Matching pattern */
+	BYTE* ext			/* Buffer to return the up-cased extension */
+)
+{
+	UINT n;
+	TCHAR c;
+
+
+	if (pat[0] != '*' || pat[1] != '.') return 0;
+	for (n = 0; (c = pat[2 + n]) != 0; n++) {
+		if (n == 12 || c == '*' || c == '?' || c == '.' || (UINT)c >= 0x80 || (UINT)c <= ' ') return 0;	/* Only plain ASCII extensions */
+		ext[n] = (BYTE)((c >= 'a' && c <= 'z') ? c - 0x20 : c);
+	}
+	return n;
+}
+
+
+/* Skips the entries whose extension can not match, without building the file information */
+
+static FRESULT find_skip_ext (
+	DIR* dp,			/* Pointer to the open directory object */
+	const BYTE* ext,	/* Up-cased extension to match */
+	UINT len			/* Length of the extension */
+)
+{
+	FRESULT res;
+	FATFS *fs = dp->obj.fs;
+	WCHAR *lfn = fs->lfnbuf;
+	UINT n, i;
+	WCHAR c;
+
+
+	for (;;) {
+		res = DIR_READ_FILE(dp);		/* Read the next entry block */
+		if (res != FR_OK) break;
+		if (dp->blk_ofs == 0xFFFFFFFF) {	/* No LFN: the name is the SFN, compare the raw extension */
+			for (i = 0; i < 3; i++) {
+				if (dp->dir[DIR_Name + 8 + i] != (i < len ? ext[i] : ' ')) break;
+			}
+			if (len <= 3 && i == 3) break;
+		} else {						/* Compare the tail of the LFN */
+			for (n = 0; lfn[n]; n++) ;
+			if (n > len && lfn[n - len - 1] == '.') {
+				for (i = 0; i < len; i++) {
+					c = lfn[n - len + i];
+					if (c >= 'a' && c <= 'z') c -= 0x20;
+					if (c != ext[i]) break;
+				}
+				if (i == len) break;
+			}
+		}
+		res = dir_next(dp, 0);			/* Not matched, go to the next entry */
+		if (res != FR_OK) break;
+	}
+	if (res == FR_OK) {					/* Move back to the top of the matched block */
+		res = dir_sdi(dp, (dp->blk_ofs == 0xFFFFFFFF) ? dp->dptr : dp->blk_ofs);
+	}
+	if (res == FR_NO_FILE) res = FR_OK;	/* Let f_readdir return end of directory */
+	return res;
+}
+#endif
+/* --- END LIBSLIM PATCH: FEAT_FIND_EXT --- */
+
+
 FRESULT f_findnext (
 	DIR* dp,		/* Pointer to the open directory object */
 	FILINFO* fno	/* Pointer to the file information structure */
 )
 {
 	FRESULT res;
+/* --- BEGIN LIBSLIM PATCH: FEAT_FIND_EXT --- */
+#if FF_USE_LFN
+	FATFS *fs;
+	BYTE ext[12];
+	UINT len;
+	DEF_NAMBUF
+#endif
+/* --- END LIBSLIM PATCH: FEAT_FIND_EXT --- */
 
 
+/* --- BEGIN LIBSLIM PATCH: FEAT_FIND_EXT --- */
+#if FF_USE_LFN
+	len = (fno && FF_USE_FIND != 2) ? find_ext_pattern(dp->pat, ext) : 0;
+#endif
+/* --- END LIBSLIM PATCH: FEAT_FIND_EXT --- */
 	for (;;) {
+/* --- BEGIN LIBSLIM PATCH: FEAT_FIND_EXT --- */
+#if FF_USE_LFN
+		if (len) {						/* Fast path for "*.ext" patterns */
+			res = validate(&dp->obj, &fs);
+			if (res == FR_OK) {
+				INIT_NAMBUF(fs);
+				res = (fs->fs_type == FS_EXFAT) ? FR_OK : find_skip_ext(dp, ext, len);
+				FREE_NAMBUF();
+			}
+#if FF_FS_REENTRANT
+			unlock_fs(fs, res);
+#endif
+			if (res != FR_OK) break;
+		}
+#endif
+/* --- END LIBSLIM PATCH: FEAT_FIND_EXT --- */
 		res = f_readdir(dp, fno);		/* Get a directory item */
 		if (res != FR_OK || !fno || !fno->fname[0]) break;	/* Terminate if any error or end of directory */
 		if (pattern_matching(dp->pat, fno->fname, 0, 0)) break;		/* Test for the file name */
@@ -5051,6 +6103,21 @@ FRESULT f_unlink (
 			}
 			if (res == FR_OK) {
 				res = dir_remove(&dj);			/* Remove the directory entry */
+/* --- BEGIN LIBSLIM PATCH: FEAT_DIR_INDEX --- */
+#if FF_USE_DIR_INDEX
+				if (dj.obj.attr & AM_DIR) dirindex_drop(fs, dclst);	/* Discard name index of the removed directory */
+#endif
+/* --- END LIBSLIM PATCH: FEAT_DIR_INDEX --- */
+/* --- BEGIN LIBSLIM PATCH: FEAT_PATH_CACHE --- */
+#if FF_USE_PATH_CACHE
+				if (dj.obj.attr & AM_DIR) pathcache_drop_volume(fs);	/* Discard cached paths through the removed directory */
+#endif
+/* --- END LIBSLIM PATCH: FEAT_PATH_CACHE --- */
+/* --- BEGIN LIBSLIM PATCH: FEAT_NEG_CACHE --- */
+#if FF_USE_NEG_CACHE
+				if (dj.obj.attr & AM_DIR) negcache_drop(fs, dclst);	/* The cluster may be reused by a new directory */
+#endif
+/* --- END LIBSLIM PATCH: FEAT_NEG_CACHE --- */
 				if (res == FR_OK && dclst != 0) {	/* Remove the cluster chain if exist */
 #if FF_FS_EXFAT
 					res = remove_chain(&obj, dclst, 0);
@@ -5242,6 +6309,11 @@ FRESULT f_rename (
 					}
 				}
 			}
+/* --- BEGIN LIBSLIM PATCH: FEAT_PATH_CACHE --- */
+#if FF_USE_PATH_CACHE
+			if (djo.obj.attr & AM_DIR) pathcache_drop_volume(fs);	/* Discard cached paths through the moved directory */
+#endif
+/* --- END LIBSLIM PATCH: FEAT_PATH_CACHE --- */
 			if (res == FR_OK) {
 				res = dir_remove(&djo);		/* Remove old entry */
 				if (res == FR_OK) {
@@ -5652,6 +6724,11 @@ FRESULT f_expand (
 				fs->free_clst -= tcl;
 				fs->fsi_flag |= 1;
 			}
+/* --- BEGIN LIBSLIM PATCH: FEAT_TRIM_BATCH --- */
+#if FF_USE_TRIM && FF_TRIM_BATCH
+			if (fs->n_trim) cancel_trim(fs, clst2sect(fs, scl), clst2sect(fs, lclst) + fs->csize - 1);	/* Do not discard the new clusters */
+#endif
+/* --- END LIBSLIM PATCH: FEAT_TRIM_BATCH --- */
 		}
 	}
 
@@ -5717,7 +6794,9 @@ FRESULT f_forward (
 				fp->flag &= (BYTE)~FA_DIRTY;
 			}
 #endif
-			if (disk_read(fs->pdrv, fp->buf, sect, 1) != RES_OK) ABORT(fs, FR_DISK_ERR);
+/* --- BEGIN LIBSLIM PATCH: FEAT_PINNED_BUF --- */
+			if (load_filebuf(fp, sect, 1) != FR_OK) ABORT(fs, FR_DISK_ERR);
+/* --- END LIBSLIM PATCH: FEAT_PINNED_BUF --- */
 		}
 		dbuf = fp->buf;
 #endif
@@ -5750,7 +6829,10 @@ static FRESULT create_partition (
 	BYTE drv,			/* Physical drive number */
 	const LBA_t plst[],	/* Partition list */
 	UINT sys,			/* System ID (for only MBR, temp setting) and bit8:GPT */
-	BYTE* buf			/* Working buffer for a sector */
+	BYTE* buf,			/* Working buffer for a sector */
+/* --- BEGIN LIBSLIM PATCH: FEAT_MKFS_ALIGN --- */
+	DWORD s_first		/* Start LBA of the first partition (for only MBR) */
+/* --- END LIBSLIM PATCH: FEAT_MKFS_ALIGN --- */
 )
 {
 	UINT i, cy;
@@ -5852,7 +6934,9 @@ static FRESULT create_partition (
 
 		mem_set(buf, 0, FF_MAX_SS);	/* Clear MBR */
 		pte = buf + MBR_Table;	/* Partition table in the MBR */
-		for (i = 0, s_lba32 = n_sc; i < 4 && s_lba32 != 0 && s_lba32 < sz_drv32; i++, s_lba32 += n_lba32) {
+/* --- BEGIN LIBSLIM PATCH: FEAT_MKFS_ALIGN --- */
+		for (i = 0, s_lba32 = s_first; i < 4 && s_lba32 != 0 && s_lba32 < sz_drv32; i++, s_lba32 += n_lba32) {
+/* --- END LIBSLIM PATCH: FEAT_MKFS_ALIGN --- */
 			n_lba32 = (DWORD)plst[i];	/* Get partition size */
 			if (n_lba32 <= 100) n_lba32 = (n_lba32 == 100) ? sz_drv32 : sz_drv32 / 100 * n_lba32;	/* Size in percentage? */
 			if (s_lba32 + n_lba32 > sz_drv32 || s_lba32 + n_lba32 < s_lba32) n_lba32 = sz_drv32 - s_lba32;	/* Clip at drive size */
@@ -5994,9 +7078,12 @@ FRESULT f_mkfs (
 			} else
 #endif
 			{	/* Partitioning is in MBR */
-				if (sz_vol > N_SEC_TRACK) {
-					b_vol = N_SEC_TRACK; sz_vol -= b_vol;	/* Estimated partition offset and size */
+/* --- BEGIN LIBSLIM PATCH: FEAT_MKFS_ALIGN --- */
+				n = (N_SEC_TRACK + sz_blk - 1) & ~(sz_blk - 1);	/* Start the partition on an erase block boundary */
+				if (sz_vol > n) {
+					b_vol = n; sz_vol -= b_vol;	/* Estimated partition offset and size */
 				}
+/* --- END LIBSLIM PATCH: FEAT_MKFS_ALIGN --- */
 			}
 		}
 	}
@@ -6041,7 +7128,9 @@ FRESULT f_mkfs (
 			if (sz_vol >= 0x80000) sz_au = 64;		/* >= 512Ks */
 			if (sz_vol >= 0x4000000) sz_au = 256;	/* >= 64Ms */
 		}
-		b_fat = b_vol + 32;										/* FAT start at offset 32 */
+/* --- BEGIN LIBSLIM PATCH: FEAT_MKFS_ALIGN --- */
+		b_fat = (b_vol + 32 + sz_blk - 1) & ~((LBA_t)sz_blk - 1);	/* FAT start at offset 32, aligned to the erase block boundary */
+/* --- END LIBSLIM PATCH: FEAT_MKFS_ALIGN --- */
 		sz_fat = (DWORD)((sz_vol / sz_au + 2) * 4 + ss - 1) / ss;	/* Number of FAT sectors */
 		b_data = (b_fat + sz_fat + sz_blk - 1) & ~((LBA_t)sz_blk - 1);	/* Align data area to the erase block boundary */
 		if (b_data - b_vol >= sz_vol / 2) LEAVE_MKFS(FR_MKFS_ABORTED);	/* Too small volume? */
@@ -6217,18 +7306,21 @@ FRESULT f_mkfs (
 				sz_dir = (DWORD)n_root * SZDIRE / ss;	/* Root dir size [sector] */
 			}
 			b_fat = b_vol + sz_rsv;						/* FAT base */
+/* --- BEGIN LIBSLIM PATCH: FEAT_MKFS_ALIGN --- */
+			n = (DWORD)(((b_fat + sz_blk - 1) & ~(sz_blk - 1)) - b_fat);	/* Align FAT to erase block boundary */
+			sz_rsv += n; b_fat += n;
+/* --- END LIBSLIM PATCH: FEAT_MKFS_ALIGN --- */
 			b_data = b_fat + sz_fat * n_fat + sz_dir;	/* Data base */
 
 			/* Align data area to erase block boundary (for flash memory media) */
 			n = (DWORD)(((b_data + sz_blk - 1) & ~(sz_blk - 1)) - b_data);	/* Sectors to next nearest from current data base */
-			if (fsty == FS_FAT32) {		/* FAT32: Move FAT */
-				sz_rsv += n; b_fat += n;
-			} else {					/* FAT: Expand FAT */
-				if (n % n_fat) {	/* Adjust fractional error if needed */
-					n--; sz_rsv++; b_fat++;
-				}
-				sz_fat += n / n_fat;
+/* --- BEGIN LIBSLIM PATCH: FEAT_MKFS_ALIGN --- */
+			/* Expand FAT so that the FAT stays aligned (FAT32 too) */
+			if (n % n_fat) {	/* Adjust fractional error if needed */
+				n--; sz_rsv++; b_fat++;
 			}
+			sz_fat += n / n_fat;
+/* --- END LIBSLIM PATCH: FEAT_MKFS_ALIGN --- */
 
 			/* Determine number of clusters and final check of validity of the FAT sub-type */
 			if (sz_vol < b_data + pau * 16 - b_vol) LEAVE_MKFS(FR_MKFS_ABORTED);	/* Too small volume? */
@@ -6325,7 +7417,12 @@ FRESULT f_mkfs (
 			} else {
 				st_dword(buf + 0, (fsty == FS_FAT12) ? 0xFFFFF8 : 0xFFFFFFF8);	/* FAT[0] and FAT[1] */
 			}
-			nsect = sz_fat;		/* Number of FAT sectors */
+/* --- BEGIN LIBSLIM PATCH: FEAT_MKFS_ALIGN --- */
+			/* Clear only the FAT sectors in use, the padding added for alignment is never read */
+			sect = b_fat + sz_fat * i;	/* Start of this FAT */
+			n = (fsty == FS_FAT32) ? (n_clst + 2) * 4 : (fsty == FS_FAT16) ? (n_clst + 2) * 2 : (n_clst * 3 + 1) / 2 + 3;
+			nsect = (n + ss - 1) / ss;	/* Number of FAT sectors in use */
+/* --- END LIBSLIM PATCH: FEAT_MKFS_ALIGN --- */
 			do {	/* Fill FAT sectors */
 				n = (nsect > sz_buf) ? sz_buf : nsect;
 				if (disk_write(pdrv, buf, sect, (UINT)n) != RES_OK) LEAVE_MKFS(FR_DISK_ERR);
@@ -6333,6 +7430,9 @@ FRESULT f_mkfs (
 				sect += n; nsect -= n;
 			} while (nsect);
 		}
+/* --- BEGIN LIBSLIM PATCH: FEAT_MKFS_ALIGN --- */
+		sect = b_fat + sz_fat * n_fat;	/* Root directory start sector */
+/* --- END LIBSLIM PATCH: FEAT_MKFS_ALIGN --- */
 
 		/* Initialize root directory (fill with zero) */
 		nsect = (fsty == FS_FAT32) ? pau : sz_dir;	/* Number of root directory sectors */
@@ -6371,7 +7471,9 @@ FRESULT f_mkfs (
 	} else {								/* Volume as a new single partition */
 		if (!(fsopt & FM_SFD)) {	/* Create partition table if not in SFD */
 			lba[0] = sz_vol, lba[1] = 0;
-			fr = create_partition(pdrv, lba, sys, buf);
+/* --- BEGIN LIBSLIM PATCH: FEAT_MKFS_ALIGN --- */
+			fr = create_partition(pdrv, lba, sys, buf, (DWORD)b_vol);
+/* --- END LIBSLIM PATCH: FEAT_MKFS_ALIGN --- */
 			if (fr != FR_OK) LEAVE_MKFS(fr);
 		}
 	}
@@ -6407,7 +7509,9 @@ FRESULT f_fdisk (
 #endif
 	if (!buf) return FR_NOT_ENOUGH_CORE;
 
-	LEAVE_MKFS(create_partition(pdrv, ptbl, 0x07, buf));
+/* --- BEGIN LIBSLIM PATCH: FEAT_MKFS_ALIGN --- */
+	LEAVE_MKFS(create_partition(pdrv, ptbl, 0x07, buf, N_SEC_TRACK));
+/* --- END LIBSLIM PATCH: FEAT_MKFS_ALIGN --- */
 }
 
 #endif /* FF_MULTI_PARTITION */
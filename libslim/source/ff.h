@@ -43,6 +43,7 @@ typedef unsigned __int64 QWORD;
 #define FF_INTDEF 2
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
 typedef bool 			BOOL;
 typedef unsigned int	UINT;	/* int must be 16-bit or 32-bit */
 typedef unsigned char	BYTE;	/* char must be 8-bit */
@@ -155,6 +156,18 @@ typedef struct {
 #if !FF_FS_READONLY
 	DWORD	last_clst;		/* Last allocated cluster */
 	DWORD	free_clst;		/* Number of free clusters */
+/* --- BEGIN LIBSLIM PATCH: FEAT_FAT_MIRROR --- */
+#if FF_FAT_MIRROR_DEFER
+	BYTE	n_mirror;		/* Number of 1st FAT sectors pending to the 2nd FAT */
+	DWORD	mirror[FF_FAT_MIRROR_DEFER];	/* Pending 1st FAT sectors (offsets from fatbase) */
+#endif
+/* --- END LIBSLIM PATCH: FEAT_FAT_MIRROR --- */
+/* --- BEGIN LIBSLIM PATCH: FEAT_TRIM_BATCH --- */
+#if FF_USE_TRIM && FF_TRIM_BATCH
+	BYTE	n_trim;			/* Number of freed sector ranges pending to be discarded */
+	LBA_t	trim[FF_TRIM_BATCH][2];	/* Pending freed sector ranges (start and end sector) */
+#endif
+/* --- END LIBSLIM PATCH: FEAT_TRIM_BATCH --- */
 #endif
 #if FF_FS_RPATH
 	DWORD	cdir;			/* Current directory start cluster (0:root) */
@@ -173,6 +186,11 @@ typedef struct {
 #if FF_FS_EXFAT
 	LBA_t	bitbase;		/* Allocation bitmap base sector */
 #endif
+/* --- BEGIN LIBSLIM PATCH: FEAT_PINNED_BUF --- */
+#if !FF_FS_TINY && FF_PINNED_FILE_BUF
+	struct FIL_*	pinned;	/* File objects holding a pinned window on this volume */
+#endif
+/* --- END LIBSLIM PATCH: FEAT_PINNED_BUF --- */
 	LBA_t	winsect;		/* Current sector appearing in the win[] */
 	BYTE	win[FF_MAX_SS] __attribute__((aligned(4)));	/* Disk access window for Directory, FAT (and file data at tiny cfg) */
 } FATFS;
@@ -204,7 +222,7 @@ typedef struct {
 
 /* File object structure (FIL) */
 
-typedef struct {
+typedef struct FIL_ {
 	FFOBJID	obj;			/* Object identifier (must be the 1st member to detect invalid object pointer) */
 	BYTE	flag;			/* File status flags */
 	BYTE	err;			/* Abort flag (error code) */
@@ -219,8 +237,15 @@ typedef struct {
 	DWORD*	cltbl;			/* Pointer to the cluster link map table (nulled on open, set by application) */
 #endif
 #if !FF_FS_TINY
+/* --- BEGIN LIBSLIM PATCH: FEAT_PINNED_BUF --- */
+#if FF_PINNED_FILE_BUF
+	BYTE*	buf;			/* Pinned sector cache block of the file data read/write window (null until loaded) */
+	struct FIL_*	pin_next;	/* Next file object holding a pinned window on the volume */
+#else
 	BYTE	buf[FF_MAX_SS] __attribute__((aligned(4)));	/* File private data read/write window */
 #endif
+/* --- END LIBSLIM PATCH: FEAT_PINNED_BUF --- */
+#endif
 } FIL;
 
 
@@ -308,6 +333,11 @@ typedef enum {
 
 FRESULT f_open (FIL* fp, const TCHAR* path, BYTE mode);				/* Open or create a file */
 FRESULT f_close (FIL* fp);											/* Close an open file object */
+/* --- BEGIN LIBSLIM PATCH: FEAT_PINNED_BUF --- */
+#if !FF_FS_TINY && FF_PINNED_FILE_BUF
+void f_unpin (FIL* fp);												/* Release the window of a file object discarded without being closed */
+#endif
+/* --- END LIBSLIM PATCH: FEAT_PINNED_BUF --- */
 FRESULT f_read (FIL* fp, void* buff, UINT btr, UINT* br);			/* Read data from the file */
 FRESULT f_write (FIL* fp, const void* buff, UINT btw, UINT* bw);	/* Write data to the file */
 FRESULT f_lseek (FIL* fp, FSIZE_t ofs);								/* Move file pointer of the file object */
@@ -375,6 +405,10 @@ DWORD ff_wtoupper (DWORD uni);			/* Unicode upper-case conversion */
 void* ff_memalloc (UINT msize);			/* Allocate memory block */
 void ff_memfree (void* mblock);			/* Free memory block */
 #endif
+/* --- BEGIN LIBSLIM PATCH: FEAT_MEM_POOL --- */
+void* ff_poolalloc (UINT msize);		/* Allocate memory block from the fixed pool if possible */
+int ff_memconfig (void* (*alloc)(size_t), void (*mfree)(void*));	/* Register the memory allocator */
+/* --- END LIBSLIM PATCH: FEAT_MEM_POOL --- */
 
 /* Sync functions */
 #if FF_FS_REENTRANT
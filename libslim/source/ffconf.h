@@ -35,12 +35,12 @@
 /  2: Enable with LF-CRLF conversion. */
 
 
-#define FF_USE_FIND		0
+#define FF_USE_FIND		1
 /* This option switches filtered directory read functions, f_findfirst() and
 /  f_findnext(). (0:Disable, 1:Enable 2:Enable with matching altname[] too) */
 
 
-#define FF_USE_MKFS		0
+#define FF_USE_MKFS		1
 /* This option switches f_mkfs() function. (0:Disable or 1:Enable) */
 
 
@@ -70,7 +70,9 @@
 / Locale and Namespace Configurations
 /---------------------------------------------------------------------------*/
 
+#ifndef FF_CODE_PAGE
 #define FF_CODE_PAGE	437
+#endif
 /* This option specifies the OEM code page to be used on the target system.
 /  Incorrect code page setting can cause a file open failure.
 /
@@ -96,6 +98,22 @@
 /   949 - Korean (DBCS)
 /   950 - Traditional Chinese (DBCS)
 /     0 - Include all code pages above and configured by f_setcp()
+/
+/  Only the conversion tables of the selected code page are compiled in. The tables
+/  of a DBCS code page take 58 to 171 KiB, and those of all code pages 470 KiB. Run
+/  `make tables` to print the table sizes of each configuration. */
+
+
+#ifndef FF_LAZY_UNI2OEM
+#define FF_LAZY_UNI2OEM	0
+#endif
+/* This option halves the conversion tables of a DBCS code page in FF_CODE_PAGE.
+/  (0:Disable or 1:Enable) When enabled, only the OEM to Unicode pairs are compiled
+/  in, and the Unicode to OEM pairs are sorted from them into the heap on the first
+/  call to ff_uni2oem(). If they can not be allocated, the OEM to Unicode pairs are
+/  searched linearly instead. This option has no effect on other code pages.
+/
+/ (Custom option added by libslim. Remove when updating a newer edition of FatFs.)
 */
 
 
@@ -119,7 +137,9 @@
 /  ff_memfree() exemplified in ffsystem.c, need to be added to the project. */
 
 
+#ifndef FF_LFN_UNICODE
 #define FF_LFN_UNICODE	1
+#endif
 /* This option switches the character encoding on the API when LFN is enabled.
 /
 /   0: ANSI/OEM in current CP (TCHAR = char)
@@ -128,15 +148,24 @@
 /   3: Unicode in UTF-32 (TCHAR = DWORD)
 /
 /  Also behavior of string I/O functions will be affected by this option.
-/  When LFN is not enabled, this option has no effect. */
+/  When LFN is not enabled, this option has no effect.
+/
+/  libslim supports 1 and 2. With 2, the UTF-8 paths of the devoptab are passed
+/  to FatFs as-is, and can be selected by defining FF_LFN_UNICODE=2. */
 
 
+#if FF_LFN_UNICODE == 2
+#define FF_LFN_BUF		765
+#else
 #define FF_LFN_BUF		255
+#endif
 #define FF_SFN_BUF		12
 /* This set of options defines size of file name members in the FILINFO structure
 /  which is used to read out directory items. These values should be suffcient for
 /  the file names to read. The maximum possible length of the read file name depends
-/  on character encoding. When LFN is not enabled, these options have no effect. */
+/  on character encoding. When LFN is not enabled, these options have no effect.
+/
+/  In UTF-8, a name of FF_MAX_LFN UTF-16 code units takes up to 3 bytes per unit. */
 
 
 #define FF_STRF_ENCODE	0
@@ -152,6 +181,28 @@
 */
 
 
+#ifndef FF_FAST_UPCASE
+#define FF_FAST_UPCASE	1
+#endif
+/* This option selects how ff_wtoupper() up-cases characters in the BMP. Names are
+/  up-cased one character at a time whenever they are compared, so this is done for
+/  every character of every long file name checked while following a path.
+/
+/   0: Search the compressed conversion table in ffunicode.c. (about 1 KiB)
+/   1: Look up a two-level table generated from it. (about 5 KiB) Every character
+/      is up-cased in constant time, and ASCII characters without a table lookup.
+/   2: Decode the two-level table from the compressed table on the first call, and
+/      look it up as in 1. The table takes about 2 KiB of BSS and 4 KiB of heap
+/      instead of 5 KiB in the binary. If it can not be allocated, the compressed
+/      table is searched as in 0.
+/
+/  The table is in ffupcase.h, which is generated by tools/mkupcase.c. Run
+/  `make upcase` to regenerate it after changing the compressed table.
+/
+/ (Custom option added by libslim. Remove when updating a newer edition of FatFs.)
+*/
+
+
 #define FF_FS_RPATH		2
 /* This option configures support for relative path.
 /
@@ -172,6 +223,148 @@
 / (Custom option added by libslim. Remove when updating a newer edition of FatFs.)
 */
 
+#define FF_USE_DIR_INDEX	1
+#define FF_DIR_INDEX_DIRS	8
+#define FF_DIR_INDEX_BUDGET	32768
+/* This option switches the in-memory name index for directory lookups on FAT
+/  volumes. When enabled, the first lookup in a directory reads the whole directory
+/  to count its entries, and again to record a hash of the case-folded name of every
+/  entry. Later lookups in the same directory only read the entries whose hash
+/  matches, and names that do not exist are rejected without reading the directory
+/  at all. The index is kept up to date as entries are created and removed.
+/
+/   0: Disable the directory name index.
+/   1: Enable the directory name index. Requires LFN to be enabled.
+/
+/  FF_DIR_INDEX_DIRS defines how many directories can be indexed at once. When
+/  every slot is in use, the least recently used directory is evicted.
+/  FF_DIR_INDEX_BUDGET defines the total heap memory in bytes shared by all indexes.
+/  Each entry takes 4 bytes, and tables are kept at most 3/4 full. Directories that
+/  do not fit in the budget are searched linearly, and the last FF_DIR_INDEX_DIRS of
+/  them are remembered so that they are not read again to build an index.
+/
+/ (Custom option added by libslim. Remove when updating a newer edition of FatFs.)
+*/
+
+
+#define FF_USE_PATH_CACHE	1
+#define FF_PATH_CACHE_ENTRIES	16
+#define FF_PATH_CACHE_MAXLEN	64
+/* This option switches the path prefix cache of the path name parser. When
+/  enabled, every directory entered while following a path is cached by its
+/  case-folded path prefix, so a later path in the same directory starts from that
+/  directory without looking up each of its segments again. Prefixes containing
+/  dot entries are not cached. Cached prefixes of a volume are discarded when a
+/  directory is renamed or removed, and when the volume is unmounted.
+/
+/   0: Disable the path prefix cache.
+/   1: Enable the path prefix cache.
+/
+/  FF_PATH_CACHE_ENTRIES defines the number of cached prefixes. When the cache is
+/  full, the least recently used prefix is replaced. FF_PATH_CACHE_MAXLEN defines
+/  the length of the longest prefix that can be cached, in characters.
+/
+/ (Custom option added by libslim. Remove when updating a newer edition of FatFs.)
+*/
+
+
+#define FF_USE_NEG_CACHE	1
+#define FF_NEG_CACHE_ENTRIES	32
+#define FF_NEG_CACHE_MAXLEN	32
+/* This option switches the negative lookup cache of the path name parser. When
+/  enabled, names that were not found in a directory are remembered together with
+/  the directory, so looking up the same missing name again does not read the
+/  directory. The entries of a directory are discarded when an entry is created or
+/  renamed into it, and every entry of a volume is discarded when it is unmounted.
+/
+/   0: Disable the negative lookup cache.
+/   1: Enable the negative lookup cache. Requires LFN to be enabled.
+/
+/  FF_NEG_CACHE_ENTRIES defines the number of cached names. When the cache is full,
+/  the oldest name is replaced. FF_NEG_CACHE_MAXLEN defines the length of the
+/  longest name that can be cached, in characters.
+/
+/ (Custom option added by libslim. Remove when updating a newer edition of FatFs.)
+*/
+
+
+#define FF_FAT_MIRROR_DEFER	16
+/* This option defines how updates of the 1st FAT are reflected to the 2nd FAT on
+/  volumes with two FATs. When deferred, the sectors of the 1st FAT that were
+/  written back are remembered and copied to the 2nd FAT only when the volume is
+/  synchronized (f_sync, f_close and functions that modify directories), when it
+/  is unmounted, or when more than FF_FAT_MIRROR_DEFER sectors are pending.
+/  Pending sectors are copied in ascending order, merging adjacent sectors into
+/  multi-sector writes.
+/
+/   0: Write each FAT sector to the 2nd FAT immediately.
+/  >0: Defer writes to the 2nd FAT for up to FF_FAT_MIRROR_DEFER sectors (1-255).
+/
+/  Until the pending sectors are copied, the 2nd FAT may be out of date.
+/
+/ (Custom option added by libslim. Remove when updating a newer edition of FatFs.)
+*/
+
+
+#define FF_MEM_POOL_BLOCKS	4
+/* This option defines the number of blocks in the fixed memory pool used for the
+/  objects that are allocated and freed on almost every call, namely the LFN working
+/  buffer (FF_USE_LFN == 3) and the cluster link map table of read-only files. Each
+/  block is the size of the LFN working buffer. When every block is in use, or the
+/  object does not fit a block, it is allocated with ff_memalloc() instead.
+/
+/   0: Disable the memory pool.
+/  >0: Number of blocks in the pool (1-32), placed on the BSS.
+/
+/ (Custom option added by libslim. Remove when updating a newer edition of FatFs.)
+*/
+
+
+#define FF_PINNED_FILE_BUF	1
+/* This option switches the data read/write window of the file object. When
+/  enabled, the window is a block of the global sector cache that is pinned while
+/  the file refers to it, instead of a private FF_MAX_SS bytes buffer embedded in
+/  the file object. This saves a sector copy on every partial sector access, and
+/  FF_MAX_SS bytes of memory per file object. When no cache block is available, a
+/  private buffer is allocated with ff_memalloc() instead.
+/
+/   0: Embed a private sector buffer in the file object.
+/   1: Use pinned sector cache blocks. Requires FF_FS_TINY to be 0.
+/
+/  The volume window (FATFS.win) stays private, because it is also used as a
+/  scratch buffer for sectors that are not read from the disk.
+/
+/ (Custom option added by libslim. Remove when updating a newer edition of FatFs.)
+*/
+
+
+#define FF_TRIM_BATCH	16
+/* This option sets the number of freed sector ranges that are held on each volume
+/  before they are discarded with CTRL_TRIM. Freed ranges that are adjacent to each
+/  other are merged, and the discard commands are issued when the volume is synced,
+/  so deleting a fragmented file or a batch of files issues a few large discards
+/  instead of one per fragment. Clusters that are allocated again before the volume
+/  is synced are taken out of the pending ranges. 0 issues the discard commands
+/  immediately. This option has no effect when FF_USE_TRIM == 0.
+/
+/ (Custom option added by libslim. Remove when updating a newer edition of FatFs.)
+*/
+
+
+#define FF_STAT_BLKSIZE	0
+/* This option switches the st_blksize reported by fstat() on the devoptab. newlib
+/  sizes the buffer of a FILE stream by st_blksize when it is set, and uses a buffer
+/  of BUFSIZ bytes otherwise.
+/
+/   0: Leave st_blksize at 0, so that streams get BUFSIZ byte buffers.
+/   1: Report the cluster size of the volume, so that buffered stream reads and
+/      writes are whole clusters. Each open stream then takes a cluster of heap.
+/
+/  The native file API in slim.h has no stream buffer, and is not affected.
+/
+/ (Custom option added by libslim. Remove when updating a newer edition of FatFs.)
+*/
+
 /*---------------------------------------------------------------------------/
 / Drive/Volume Configurations
 /---------------------------------------------------------------------------*/
@@ -217,7 +410,7 @@
 /  f_fdisk function. 0x100000000 max. This option has no effect when FF_LBA64 == 0. */
 
 
-#define FF_USE_TRIM		0
+#define FF_USE_TRIM		1
 /* This option switches support for ATA-TRIM. (0:Disable or 1:Enable)
 /  To enable Trim function, also CTRL_TRIM command should be implemented to the
 /  disk_ioctl() function. */
@@ -235,7 +428,7 @@
 /  buffer in the filesystem object (FATFS) is used for the file data transfer. */
 
 
-#define FF_FS_EXFAT		0
+#define FF_FS_EXFAT		1
 /* This option switches support for exFAT filesystem. (0:Disable or 1:Enable)
 /  To enable exFAT, also LFN needs to be enabled. (FF_USE_LFN >= 1)
 /  Note that enabling exFAT discards ANSI C (C89) compatibility. */
@@ -279,10 +472,14 @@
 /      lock control is independent of re-entrancy. */
 
 
-/* #include <somertos.h>	// O/S definitions */
+#ifndef FF_FS_REENTRANT
 #define FF_FS_REENTRANT	0
+#endif
+#if FF_FS_REENTRANT
+#include <pthread.h>	// O/S definitions
+#endif
 #define FF_FS_TIMEOUT	1000
-#define FF_SYNC_t		HANDLE
+#define FF_SYNC_t		pthread_mutex_t*
 /* The option FF_FS_REENTRANT switches the re-entrancy (thread safe) of the FatFs
 /  module itself. Note that regardless of this option, file access to different
 /  volume is always re-entrant and volume control functions, f_mount(), f_mkfs()
@@ -298,7 +495,12 @@
 /  The FF_FS_TIMEOUT defines timeout period in unit of time tick.
 /  The FF_SYNC_t defines O/S dependent sync object type. e.g. HANDLE, ID, OS_EVENT*,
 /  SemaphoreHandle_t and etc. A header file for O/S definitions needs to be
-/  included somewhere in the scope of ff.h. */
+/  included somewhere in the scope of ff.h.
+/
+/  libslim provides POSIX threads handlers in ffsystem.c, and the timeout is in
+/  milliseconds. Re-entrancy can be enabled by defining FF_FS_REENTRANT=1 on hosted
+/  builds with POSIX threads. The sector cache and lookup caches shared between
+/  volumes are then locked as well, so different volumes can be accessed concurrently. */
 
 
 
@@ -5,10 +5,82 @@
 
 
 #include "ff.h"
+#include "cache.h"
+#include "lock.h"
 #include <stdlib.h>
+#include <time.h>
 
 #if FF_USE_LFN == 3	|| SLIM_USE_CACHE || FF_USE_FASTSEEK/* Dynamic memory allocation */
 
+/* --- BEGIN LIBSLIM PATCH: FEAT_MEM_POOL --- */
+static void* (*mem_alloc)(size_t) = malloc;	/* Registered allocator */
+static void (*mem_free)(void*) = free;
+static BOOL mem_used;						/* Set once the allocator was used */
+
+#if FF_MEM_POOL_BLOCKS
+#if FF_MEM_POOL_BLOCKS > 32
+#error Wrong FF_MEM_POOL_BLOCKS setting
+#endif
+#if FF_USE_LFN && FF_FS_EXFAT
+#define POOL_BLOCK_SIZE	((FF_MAX_LFN + 1) * 2 + (FF_MAX_LFN + 44U) / 15 * 32)	/* LFN working buffer and directory entry block */
+#elif FF_USE_LFN
+#define POOL_BLOCK_SIZE	((FF_MAX_LFN + 1) * 2)	/* LFN working buffer */
+#else
+#define POOL_BLOCK_SIZE	128
+#endif
+#define POOL_BLOCK_WORDS	((POOL_BLOCK_SIZE + 31) / 32 * 8)	/* Blocks are rounded up to 32 bytes */
+
+static DWORD mem_pool[FF_MEM_POOL_BLOCKS][POOL_BLOCK_WORDS] __attribute__((aligned(32)));
+static DWORD mem_pool_used;	/* Bitmap of blocks in use */
+static SLIM_LOCK mem_pool_lock = SLIM_LOCK_INIT;	/* The pool is shared between volumes */
+#endif
+
+
+/*------------------------------------------------------------------------*/
+/* Register a memory allocator                                            */
+/*------------------------------------------------------------------------*/
+
+int ff_memconfig (	/* Returns 1 if registered, 0 if memory was already allocated */
+	void* (*alloc)(size_t),	/* Allocation function (null: malloc) */
+	void (*mfree)(void*)	/* Free function (null: free) */
+)
+{
+	if (mem_used) return 0;	/* Blocks of the previous allocator may still be alive */
+	mem_alloc = alloc ? alloc : malloc;
+	mem_free = mfree ? mfree : free;
+	return 1;
+}
+
+
+/*------------------------------------------------------------------------*/
+/* Allocate a memory block from the fixed pool                            */
+/*------------------------------------------------------------------------*/
+
+void* ff_poolalloc (	/* Returns pointer to the allocated memory block (null if not enough core) */
+	UINT msize		/* Number of bytes to allocate */
+)
+{
+#if FF_MEM_POOL_BLOCKS
+	UINT i;
+
+
+	if (msize <= sizeof mem_pool[0]) {
+		slim_lock(&mem_pool_lock);
+		for (i = 0; i < FF_MEM_POOL_BLOCKS; i++) {
+			if (!(mem_pool_used & (1UL << i))) {
+				mem_pool_used |= 1UL << i;
+				slim_unlock(&mem_pool_lock);
+				return mem_pool[i];
+			}
+		}
+		slim_unlock(&mem_pool_lock);
+	}
+#endif
+	return ff_memalloc(msize);	/* Pool is exhausted or the block does not fit */
+}
+/* --- END LIBSLIM PATCH: FEAT_MEM_POOL --- */
+
+
 /*------------------------------------------------------------------------*/
 /* Allocate a memory block                                                */
 /*------------------------------------------------------------------------*/
@@ -17,7 +89,10 @@ void* ff_memalloc (	/* Returns pointer to the allocated memory block (null if no
 	UINT msize		/* Number of bytes to allocate */
 )
 {
-	return malloc(msize);	/* Allocate a new memory block with POSIX API */
+/* --- BEGIN LIBSLIM PATCH: FEAT_MEM_POOL --- */
+	mem_used = 1;
+	return mem_alloc(msize);	/* Allocate a new memory block with the registered allocator */
+/* --- END LIBSLIM PATCH: FEAT_MEM_POOL --- */
 }
 
 
@@ -29,7 +104,17 @@ void ff_memfree (
 	void* mblock	/* Pointer to the memory block to free (nothing to do if null) */
 )
 {
-	free(mblock);	/* Free the memory block with POSIX API */
+/* --- BEGIN LIBSLIM PATCH: FEAT_MEM_POOL --- */
+#if FF_MEM_POOL_BLOCKS
+	if ((BYTE*)mblock >= (BYTE*)mem_pool && (BYTE*)mblock < (BYTE*)mem_pool + sizeof mem_pool) {	/* Block of the fixed pool? */
+		slim_lock(&mem_pool_lock);
+		mem_pool_used &= ~(1UL << (((BYTE*)mblock - (BYTE*)mem_pool) / sizeof mem_pool[0]));
+		slim_unlock(&mem_pool_lock);
+		return;
+	}
+#endif
+	if (mblock) mem_free(mblock);	/* Free the memory block with the registered allocator */
+/* --- END LIBSLIM PATCH: FEAT_MEM_POOL --- */
 }
 
 #endif
@@ -47,6 +132,9 @@ void ff_memfree (
 */
 
 //const osMutexDef_t Mutex[FF_VOLUMES];	/* Table of CMSIS-RTOS mutex */
+/* --- BEGIN LIBSLIM PATCH: FEAT_REENTRANT --- */
+static pthread_mutex_t Mutex[FF_VOLUMES];	/* Table of POSIX threads mutex */
+/* --- END LIBSLIM PATCH: FEAT_REENTRANT --- */
 
 
 int ff_cre_syncobj (	/* 1:Function succeeded, 0:Could not create the sync object */
@@ -54,9 +142,15 @@ int ff_cre_syncobj (	/* 1:Function succeeded, 0:Could not create the sync object
 	FF_SYNC_t* sobj		/* Pointer to return the created sync object */
 )
 {
+/* --- BEGIN LIBSLIM PATCH: FEAT_REENTRANT --- */
+	/* POSIX threads */
+	*sobj = &Mutex[vol];
+	return (int)(pthread_mutex_init(*sobj, NULL) == 0);
+/* --- END LIBSLIM PATCH: FEAT_REENTRANT --- */
+
 	/* Win32 */
-	*sobj = CreateMutex(NULL, FALSE, NULL);
-	return (int)(*sobj != INVALID_HANDLE_VALUE);
+//	*sobj = CreateMutex(NULL, FALSE, NULL);
+//	return (int)(*sobj != INVALID_HANDLE_VALUE);
 
 	/* uITRON */
 //	T_CSEM csem = {TA_TPRI,1,1};
@@ -90,8 +184,13 @@ int ff_del_syncobj (	/* 1:Function succeeded, 0:Could not delete due to an error
 	FF_SYNC_t sobj		/* Sync object tied to the logical drive to be deleted */
 )
 {
+/* --- BEGIN LIBSLIM PATCH: FEAT_REENTRANT --- */
+	/* POSIX threads */
+	return (int)(pthread_mutex_destroy(sobj) == 0);
+/* --- END LIBSLIM PATCH: FEAT_REENTRANT --- */
+
 	/* Win32 */
-	return (int)CloseHandle(sobj);
+//	return (int)CloseHandle(sobj);
 
 	/* uITRON */
 //	return (int)(del_sem(sobj) == E_OK);
@@ -121,8 +220,21 @@ int ff_req_grant (	/* 1:Got a grant to access the volume, 0:Could not get a gran
 	FF_SYNC_t sobj	/* Sync object to wait */
 )
 {
+/* --- BEGIN LIBSLIM PATCH: FEAT_REENTRANT --- */
+	/* POSIX threads */
+	struct timespec ts;
+
+	clock_gettime(CLOCK_REALTIME, &ts);	/* Wait for FF_FS_TIMEOUT milliseconds at most */
+	ts.tv_sec += FF_FS_TIMEOUT / 1000;
+	ts.tv_nsec += (long)(FF_FS_TIMEOUT % 1000) * 1000000;
+	if (ts.tv_nsec >= 1000000000) {
+		ts.tv_sec++; ts.tv_nsec -= 1000000000;
+	}
+	return (int)(pthread_mutex_timedlock(sobj, &ts) == 0);
+/* --- END LIBSLIM PATCH: FEAT_REENTRANT --- */
+
 	/* Win32 */
-	return (int)(WaitForSingleObject(sobj, FF_FS_TIMEOUT) == WAIT_OBJECT_0);
+//	return (int)(WaitForSingleObject(sobj, FF_FS_TIMEOUT) == WAIT_OBJECT_0);
 
 	/* uITRON */
 //	return (int)(wai_sem(sobj) == E_OK);
@@ -150,8 +262,13 @@ void ff_rel_grant (
 	FF_SYNC_t sobj	/* Sync object to be signaled */
 )
 {
+/* --- BEGIN LIBSLIM PATCH: FEAT_REENTRANT --- */
+	/* POSIX threads */
+	pthread_mutex_unlock(sobj);
+/* --- END LIBSLIM PATCH: FEAT_REENTRANT --- */
+
 	/* Win32 */
-	ReleaseMutex(sobj);
+//	ReleaseMutex(sobj);
 
 	/* uITRON */
 //	sig_sem(sobj);
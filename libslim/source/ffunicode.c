@@ -36,6 +36,9 @@
 /*------------------------------------------------------------------------*/
 
 #if FF_CODE_PAGE == 932 || FF_CODE_PAGE == 0	/* Japanese */
+/* --- BEGIN LIBSLIM PATCH: FEAT_LAZY_UNI2OEM --- */
+#if !FF_LAZY_UNI2OEM || FF_CODE_PAGE == 0
+/* --- END LIBSLIM PATCH: FEAT_LAZY_UNI2OEM --- */
 static const WCHAR uni2oem932[] = {	/* Unicode --> Shift_JIS pairs */
 	0x00A7, 0x8198, 0x00A8, 0x814E, 0x00B0, 0x818B, 0x00B1, 0x817D,	0x00B4, 0x814C, 0x00B6, 0x81F7, 0x00D7, 0x817E, 0x00F7, 0x8180,
 	0x0391, 0x839F, 0x0392, 0x83A0, 0x0393, 0x83A1, 0x0394, 0x83A2,	0x0395, 0x83A3, 0x0396, 0x83A4, 0x0397, 0x83A5, 0x0398, 0x83A6,
@@ -962,6 +965,9 @@ static const WCHAR uni2oem932[] = {	/* Unicode --> Shift_JIS pairs */
 	0xFF99, 0x00D9, 0xFF9A, 0x00DA, 0xFF9B, 0x00DB, 0xFF9C, 0x00DC,	0xFF9D, 0x00DD, 0xFF9E, 0x00DE, 0xFF9F, 0x00DF, 0xFFE0, 0x8191,
 	0xFFE1, 0x8192, 0xFFE2, 0x81CA, 0xFFE3, 0x8150, 0xFFE4, 0xFA55,	0xFFE5, 0x818F, 0, 0
 };
+/* --- BEGIN LIBSLIM PATCH: FEAT_LAZY_UNI2OEM --- */
+#endif
+/* --- END LIBSLIM PATCH: FEAT_LAZY_UNI2OEM --- */
 
 static const WCHAR oem2uni932[] = {	/* Shift_JIS --> Unicode pairs */
 	0x00A1, 0xFF61, 0x00A2, 0xFF62, 0x00A3, 0xFF63, 0x00A4, 0xFF64,	0x00A5, 0xFF65, 0x00A6, 0xFF66, 0x00A7, 0xFF67, 0x00A8, 0xFF68,
@@ -1892,6 +1898,9 @@ static const WCHAR oem2uni932[] = {	/* Shift_JIS --> Unicode pairs */
 #endif
 
 #if FF_CODE_PAGE == 936 || FF_CODE_PAGE == 0	/* Simplified Chinese */
+/* --- BEGIN LIBSLIM PATCH: FEAT_LAZY_UNI2OEM --- */
+#if !FF_LAZY_UNI2OEM || FF_CODE_PAGE == 0
+/* --- END LIBSLIM PATCH: FEAT_LAZY_UNI2OEM --- */
 static const WCHAR uni2oem936[] = {	/* Unicode --> GBK pairs */
 	0x00A4, 0xA1E8, 0x00A7, 0xA1EC, 0x00A8, 0xA1A7, 0x00B0, 0xA1E3,	0x00B1, 0xA1C0, 0x00B7, 0xA1A4, 0x00D7, 0xA1C1, 0x00E0, 0xA8A4,
 	0x00E1, 0xA8A2, 0x00E8, 0xA8A8, 0x00E9, 0xA8A6, 0x00EA, 0xA8BA,	0x00EC, 0xA8AC, 0x00ED, 0xA8AA, 0x00F2, 0xA8B0, 0x00F3, 0xA8AE,
@@ -4619,6 +4628,9 @@ static const WCHAR uni2oem936[] = {	/* Unicode --> GBK pairs */
 	0xFF5D, 0xA3FD, 0xFF5E, 0xA1AB, 0xFFE0, 0xA1E9, 0xFFE1, 0xA1EA,	0xFFE2, 0xA956, 0xFFE3, 0xA3FE, 0xFFE4, 0xA957, 0xFFE5, 0xA3A4,
 	0, 0
 };
+/* --- BEGIN LIBSLIM PATCH: FEAT_LAZY_UNI2OEM --- */
+#endif
+/* --- END LIBSLIM PATCH: FEAT_LAZY_UNI2OEM --- */
 
 static const WCHAR oem2uni936[] = {	/* GBK --> Unicode pairs */
 	0x0080, 0x20AC, 0x8140, 0x4E02, 0x8141, 0x4E04, 0x8142, 0x4E05,	0x8143, 0x4E06, 0x8144, 0x4E0F, 0x8145, 0x4E12, 0x8146, 0x4E17,
@@ -7350,6 +7362,9 @@ static const WCHAR oem2uni936[] = {	/* GBK --> Unicode pairs */
 #endif
 
 #if FF_CODE_PAGE == 949 || FF_CODE_PAGE == 0	/* Korean */
+/* --- BEGIN LIBSLIM PATCH: FEAT_LAZY_UNI2OEM --- */
+#if !FF_LAZY_UNI2OEM || FF_CODE_PAGE == 0
+/* --- END LIBSLIM PATCH: FEAT_LAZY_UNI2OEM --- */
 static const WCHAR uni2oem949[] = {	/* Unicode --> Korean pairs */
 	0x00A1, 0xA2AE, 0x00A4, 0xA2B4, 0x00A7, 0xA1D7, 0x00A8, 0xA1A7,	0x00AA, 0xA8A3, 0x00AD, 0xA1A9, 0x00AE, 0xA2E7, 0x00B0, 0xA1C6,
 	0x00B1, 0xA1BE, 0x00B2, 0xA9F7, 0x00B3, 0xA9F8, 0x00B4, 0xA2A5,	0x00B6, 0xA2D2, 0x00B7, 0xA1A4, 0x00B8, 0xA2AC, 0x00B9, 0xA9F6,
@@ -9484,6 +9499,9 @@ static const WCHAR uni2oem949[] = {	/* Unicode --> Korean pairs */
 	0xFF5D, 0xA3FD, 0xFF5E, 0xA2A6, 0xFFE0, 0xA1CB, 0xFFE1, 0xA1CC,	0xFFE2, 0xA1FE, 0xFFE3, 0xA3FE, 0xFFE5, 0xA1CD, 0xFFE6, 0xA3DC,
 	0, 0
 };
+/* --- BEGIN LIBSLIM PATCH: FEAT_LAZY_UNI2OEM --- */
+#endif
+/* --- END LIBSLIM PATCH: FEAT_LAZY_UNI2OEM --- */
 
 static const WCHAR oem2uni949[] = {	/* Korean --> Unicode pairs */
 	0x8141, 0xAC02, 0x8142, 0xAC03, 0x8143, 0xAC05, 0x8144, 0xAC06,	0x8145, 0xAC0B, 0x8146, 0xAC0C, 0x8147, 0xAC0D, 0x8148, 0xAC0E,
@@ -11622,6 +11640,9 @@ static const WCHAR oem2uni949[] = {	/* Korean --> Unicode pairs */
 #endif
 
 #if FF_CODE_PAGE == 950 || FF_CODE_PAGE == 0	/* Traditional Chinese */
+/* --- BEGIN LIBSLIM PATCH: FEAT_LAZY_UNI2OEM --- */
+#if !FF_LAZY_UNI2OEM || FF_CODE_PAGE == 0
+/* --- END LIBSLIM PATCH: FEAT_LAZY_UNI2OEM --- */
 static const WCHAR uni2oem950[] = {	/* Unicode --> Big5 pairs */
 	0x00A7, 0xA1B1, 0x00AF, 0xA1C2, 0x00B0, 0xA258, 0x00B1, 0xA1D3,	0x00B7, 0xA150, 0x00D7, 0xA1D1, 0x00F7, 0xA1D2, 0x02C7, 0xA3BE,
 	0x02C9, 0xA3BC, 0x02CA, 0xA3BD, 0x02CB, 0xA3BF, 0x02CD, 0xA1C5,	0x02D9, 0xA3BB, 0x0391, 0xA344, 0x0392, 0xA345, 0x0393, 0xA346,
@@ -13312,6 +13333,9 @@ static const WCHAR uni2oem950[] = {	/* Unicode --> Big5 pairs */
 	0xFF54, 0xA2FC, 0xFF55, 0xA2FD, 0xFF56, 0xA2FE, 0xFF57, 0xA340,	0xFF58, 0xA341, 0xFF59, 0xA342, 0xFF5A, 0xA343, 0xFF5B, 0xA161,
 	0xFF5C, 0xA155, 0xFF5D, 0xA162, 0xFF5E, 0xA1E3, 0xFFE0, 0xA246,	0xFFE1, 0xA247, 0xFFE3, 0xA1C3, 0xFFE5, 0xA244, 0, 0
 };
+/* --- BEGIN LIBSLIM PATCH: FEAT_LAZY_UNI2OEM --- */
+#endif
+/* --- END LIBSLIM PATCH: FEAT_LAZY_UNI2OEM --- */
 
 static const WCHAR oem2uni950[] = {	/* Big5 --> Unicode pairs */
 	0xA140, 0x3000, 0xA141, 0xFF0C, 0xA142, 0x3001, 0xA143, 0x3002,	0xA144, 0xFF0E, 0xA145, 0x2027, 0xA146, 0xFF1B, 0xA147, 0xFF1A,
@@ -15272,6 +15296,75 @@ WCHAR ff_oem2uni (	/* Returns Unicode character in UTF-16, zero on error */
 /*------------------------------------------------------------------------*/
 
 #if FF_CODE_PAGE >= 900
+/* --- BEGIN LIBSLIM PATCH: FEAT_LAZY_UNI2OEM --- */
+#if FF_LAZY_UNI2OEM
+#include "lock.h"
+
+static WCHAR *Uni2oem;	/* Unicode --> OEM pairs, built on first use */
+static BYTE Uni2oemFailed;	/* The pairs could not be allocated */
+static SLIM_LOCK Uni2oemLock = SLIM_LOCK_INIT;
+
+static void uni2oem_sift (DWORD *key, UINT i, UINT n)	/* Sifts down key[i] of the heap key[0..n-1] */
+{
+	UINT c;
+	DWORD k = key[i];
+
+	while ((c = i * 2 + 1) < n) {
+		if (c + 1 < n && key[c + 1] > key[c]) c++;
+		if (k >= key[c]) break;
+		key[i] = key[c]; i = c;
+	}
+	key[i] = k;
+}
+
+/* Builds the Unicode --> OEM pairs by sorting the OEM --> Unicode pairs by Unicode and
+/  then OEM code, which gives the same pairs in the same order as the uni2oem table.
+/  Both tables end with a 0, 0 pair, which is kept at the end. */
+static const WCHAR *uni2oem_table (void)
+{
+	const WCHAR *p = CVTBL(oem2uni, FF_CODE_PAGE);
+	WCHAR *tbl;
+	DWORD *key, k;
+	UINT i, n = sizeof CVTBL(oem2uni, FF_CODE_PAGE) / 4;
+
+#if FF_FS_REENTRANT
+	tbl = __atomic_load_n(&Uni2oem, __ATOMIC_ACQUIRE);
+#else
+	tbl = Uni2oem;
+#endif
+	if (tbl) return tbl;
+
+	slim_lock(&Uni2oemLock);
+	if (!Uni2oem && !Uni2oemFailed) {
+		key = ff_memalloc(n * sizeof (DWORD));
+		if (key) {
+			for (i = 0; i < n; i++) key[i] = (DWORD)p[i * 2 + 1] << 16 | p[i * 2];
+			for (i = (n - 1) / 2; i > 0; i--) uni2oem_sift(key, i - 1, n - 1);	/* Heap sort the keys but the last */
+			for (i = n - 2; i > 0; i--) {
+				k = key[0]; key[0] = key[i]; key[i] = k;
+				uni2oem_sift(key, 0, i);
+			}
+			tbl = (WCHAR*)key;
+			for (i = 0; i < n; i++) {	/* Unpack the keys into pairs in place */
+				k = key[i];
+				tbl[i * 2] = (WCHAR)(k >> 16); tbl[i * 2 + 1] = (WCHAR)k;
+			}
+#if FF_FS_REENTRANT
+			__atomic_store_n(&Uni2oem, tbl, __ATOMIC_RELEASE);
+#else
+			Uni2oem = tbl;
+#endif
+		} else {
+			Uni2oemFailed = 1;
+		}
+	}
+	tbl = Uni2oem;
+	slim_unlock(&Uni2oemLock);
+	return tbl;
+}
+#endif
+/* --- END LIBSLIM PATCH: FEAT_LAZY_UNI2OEM --- */
+
 WCHAR ff_uni2oem (	/* Returns OEM code character, zero on error */
 	DWORD	uni,	/* UTF-16 encoded character to be converted */
 	WORD	cp		/* Code page for the conversion */
@@ -15288,8 +15381,22 @@ WCHAR ff_uni2oem (	/* Returns OEM code character, zero on error */
 	} else {			/* Non-ASCII */
 		if (uni < 0x10000 && cp == FF_CODE_PAGE) {	/* Is it in BMP and valid code page? */
 			uc = (WCHAR)uni;
+/* --- BEGIN LIBSLIM PATCH: FEAT_LAZY_UNI2OEM --- */
+#if FF_LAZY_UNI2OEM
+			p = uni2oem_table();
+			if (!p) {	/* Search the OEM --> Unicode pairs if the table could not be built */
+				p = CVTBL(oem2uni, FF_CODE_PAGE);	/* (A few characters in CP950 have two OEM codes, either may be found) */
+				for (i = 0; i < sizeof CVTBL(oem2uni, FF_CODE_PAGE) / 4 - 1 && p[i * 2 + 1] != uc; i++) ;
+				return p[i * 2 + 1] == uc ? p[i * 2] : 0;
+			}
+			hi = sizeof CVTBL(oem2uni, FF_CODE_PAGE) / 4 - 1;
+#else
+/* --- END LIBSLIM PATCH: FEAT_LAZY_UNI2OEM --- */
 			p = CVTBL(uni2oem, FF_CODE_PAGE);
 			hi = sizeof CVTBL(uni2oem, FF_CODE_PAGE) / 4 - 1;
+/* --- BEGIN LIBSLIM PATCH: FEAT_LAZY_UNI2OEM --- */
+#endif
+/* --- END LIBSLIM PATCH: FEAT_LAZY_UNI2OEM --- */
 			li = 0;
 			for (n = 16; n; n--) {
 				i = li + (hi - li) / 2;
@@ -15461,103 +15568,205 @@ WCHAR ff_oem2uni (	/* Returns Unicode character in UTF-16, zero on error */
 /* Unicode up-case conversion                                             */
 /*------------------------------------------------------------------------*/
 
+/* --- BEGIN LIBSLIM PATCH: FEAT_FAST_UPCASE --- */
+#if FF_FAST_UPCASE != 1
+static const WORD cvt1[] = {	/* Compressed up conversion table for U+0000 - U+0FFF */
+	/* Basic Latin */
+	0x0061,0x031A,
+	/* Latin-1 Supplement */
+	0x00E0,0x0317,
+	0x00F8,0x0307,
+	0x00FF,0x0001,0x0178,
+	/* Latin Extended-A */
+	0x0100,0x0130,
+	0x0132,0x0106,
+	0x0139,0x0110,
+	0x014A,0x012E,
+	0x0179,0x0106,
+	/* Latin Extended-B */
+	0x0180,0x004D,0x0243,0x0181,0x0182,0x0182,0x0184,0x0184,0x0186,0x0187,0x0187,0x0189,0x018A,0x018B,0x018B,0x018D,0x018E,0x018F,0x0190,0x0191,0x0191,0x0193,0x0194,0x01F6,0x0196,0x0197,0x0198,0x0198,0x023D,0x019B,0x019C,0x019D,0x0220,0x019F,0x01A0,0x01A0,0x01A2,0x01A2,0x01A4,0x01A4,0x01A6,0x01A7,0x01A7,0x01A9,0x01AA,0x01AB,0x01AC,0x01AC,0x01AE,0x01AF,0x01AF,0x01B1,0x01B2,0x01B3,0x01B3,0x01B5,0x01B5,0x01B7,0x01B8,0x01B8,0x01BA,0x01BB,0x01BC,0x01BC,0x01BE,0x01F7,0x01C0,0x01C1,0x01C2,0x01C3,0x01C4,0x01C5,0x01C4,0x01C7,0x01C8,0x01C7,0x01CA,0x01CB,0x01CA,
+	0x01CD,0x0110,
+	0x01DD,0x0001,0x018E,
+	0x01DE,0x0112,
+	0x01F3,0x0003,0x01F1,0x01F4,0x01F4,
+	0x01F8,0x0128,
+	0x0222,0x0112,
+	0x023A,0x0009,0x2C65,0x023B,0x023B,0x023D,0x2C66,0x023F,0x0240,0x0241,0x0241,
+	0x0246,0x010A,
+	/* IPA Extensions */
+	0x0253,0x0040,0x0181,0x0186,0x0255,0x0189,0x018A,0x0258,0x018F,0x025A,0x0190,0x025C,0x025D,0x025E,0x025F,0x0193,0x0261,0x0262,0x0194,0x0264,0x0265,0x0266,0x0267,0x0197,0x0196,0x026A,0x2C62,0x026C,0x026D,0x026E,0x019C,0x0270,0x0271,0x019D,0x0273,0x0274,0x019F,0x0276,0x0277,0x0278,0x0279,0x027A,0x027B,0x027C,0x2C64,0x027E,0x027F,0x01A6,0x0281,0x0282,0x01A9,0x0284,0x0285,0x0286,0x0287,0x01AE,0x0244,0x01B1,0x01B2,0x0245,0x028D,0x028E,0x028F,0x0290,0x0291,0x01B7,
+	/* Greek, Coptic */
+	0x037B,0x0003,0x03FD,0x03FE,0x03FF,
+	0x03AC,0x0004,0x0386,0x0388,0x0389,0x038A,
+	0x03B1,0x0311,
+	0x03C2,0x0002,0x03A3,0x03A3,
+	0x03C4,0x0308,
+	0x03CC,0x0003,0x038C,0x038E,0x038F,
+	0x03D8,0x0118,
+	0x03F2,0x000A,0x03F9,0x03F3,0x03F4,0x03F5,0x03F6,0x03F7,0x03F7,0x03F9,0x03FA,0x03FA,
+	/* Cyrillic */
+	0x0430,0x0320,
+	0x0450,0x0710,
+	0x0460,0x0122,
+	0x048A,0x0136,
+	0x04C1,0x010E,
+	0x04CF,0x0001,0x04C0,
+	0x04D0,0x0144,
+	/* Armenian */
+	0x0561,0x0426,
+
+	0x0000	/* EOT */
+};
+static const WORD cvt2[] = {	/* Compressed up conversion table for U+1000 - U+FFFF */
+	/* Phonetic Extensions */
+	0x1D7D,0x0001,0x2C63,
+	/* Latin Extended Additional */
+	0x1E00,0x0196,
+	0x1EA0,0x015A,
+	/* Greek Extended */
+	0x1F00,0x0608,
+	0x1F10,0x0606,
+	0x1F20,0x0608,
+	0x1F30,0x0608,
+	0x1F40,0x0606,
+	0x1F51,0x0007,0x1F59,0x1F52,0x1F5B,0x1F54,0x1F5D,0x1F56,0x1F5F,
+	0x1F60,0x0608,
+	0x1F70,0x000E,0x1FBA,0x1FBB,0x1FC8,0x1FC9,0x1FCA,0x1FCB,0x1FDA,0x1FDB,0x1FF8,0x1FF9,0x1FEA,0x1FEB,0x1FFA,0x1FFB,
+	0x1F80,0x0608,
+	0x1F90,0x0608,
+	0x1FA0,0x0608,
+	0x1FB0,0x0004,0x1FB8,0x1FB9,0x1FB2,0x1FBC,
+	0x1FCC,0x0001,0x1FC3,
+	0x1FD0,0x0602,
+	0x1FE0,0x0602,
+	0x1FE5,0x0001,0x1FEC,
+	0x1FF3,0x0001,0x1FFC,
+	/* Letterlike Symbols */
+	0x214E,0x0001,0x2132,
+	/* Number forms */
+	0x2170,0x0210,
+	0x2184,0x0001,0x2183,
+	/* Enclosed Alphanumerics */
+	0x24D0,0x051A,
+	0x2C30,0x042F,
+	/* Latin Extended-C */
+	0x2C60,0x0102,
+	0x2C67,0x0106, 0x2C75,0x0102,
+	/* Coptic */
+	0x2C80,0x0164,
+	/* Georgian Supplement */
+	0x2D00,0x0826,
+	/* Full-width */
+	0xFF41,0x031A,
+
+	0x0000	/* EOT */
+};
+#endif
+
+#if FF_FAST_UPCASE == 1
+#include "ffupcase.h"
+
+#elif FF_FAST_UPCASE == 2
+#include "lock.h"
+
+#define UPCASE_BLOCK_BITS	5
+#define UPCASE_BLOCK_SIZE	(1 << UPCASE_BLOCK_BITS)
+
+static DWORD wtoupper_cvt (DWORD uni);
+
+static BYTE UpcaseIndex[0x10000 >> UPCASE_BLOCK_BITS];	/* Block of the deltas of each 32 characters */
+static WORD *UpcaseDelta;	/* Up-cased character - character, decoded on first use */
+static BYTE UpcaseFailed;	/* The table could not be allocated */
+static SLIM_LOCK UpcaseLock = SLIM_LOCK_INIT;
+
+/* Decodes the compressed table into the two-level table of the deltas. Only the blocks
+/  of 32 characters touched by the compressed table are stored, the others share block 0. */
+static void upcase_decode (void)
+{
+	static const WORD *const cvt[] = {cvt1, cvt2};
+	const WORD *p;
+	WORD *delta;
+	UINT i, b, n;
+	WORD bc, nc;
+	DWORD uc;
+
+	for (i = n = 0; i < 2; i++) {	/* Mark the blocks touched by each table */
+		for (p = cvt[i]; (bc = *p++) != 0; ) {
+			nc = *p++;
+			for (b = bc >> UPCASE_BLOCK_BITS; b <= (UINT)(bc + (nc & 0xFF) - 1) >> UPCASE_BLOCK_BITS; b++) {
+				if (!UpcaseIndex[b]) { UpcaseIndex[b] = 1; n++; }
+			}
+			if ((nc >> 8) == 0) p += nc & 0xFF;	/* Skip table if needed */
+		}
+	}
+	delta = n < 256 ? ff_memalloc((n + 1) * UPCASE_BLOCK_SIZE * sizeof (WORD)) : 0;
+	if (!delta) {
+		for (b = 0; b < sizeof UpcaseIndex; b++) UpcaseIndex[b] = 0;
+		UpcaseFailed = 1;
+		return;
+	}
+	for (i = 0; i < UPCASE_BLOCK_SIZE; i++) delta[i] = 0;	/* Block 0 does not change any character */
+	for (b = 0, n = 1; b < sizeof UpcaseIndex; b++) {
+		if (!UpcaseIndex[b]) continue;
+		for (i = 0; i < UPCASE_BLOCK_SIZE; i++) {
+			uc = (DWORD)b << UPCASE_BLOCK_BITS | i;
+			delta[n << UPCASE_BLOCK_BITS | i] = (WORD)(wtoupper_cvt(uc) - uc);
+		}
+		UpcaseIndex[b] = (BYTE)n++;
+	}
+#if FF_FS_REENTRANT
+	__atomic_store_n(&UpcaseDelta, delta, __ATOMIC_RELEASE);
+#else
+	UpcaseDelta = delta;
+#endif
+}
+#endif
+
+#if FF_FAST_UPCASE
 DWORD ff_wtoupper (	/* Returns up-converted code point */
 	DWORD uni		/* Unicode code point to be up-converted */
 )
 {
-	const WORD *p;
-	WORD uc, bc, nc, cmd;
-	static const WORD cvt1[] = {	/* Compressed up conversion table for U+0000 - U+0FFF */
-		/* Basic Latin */
-		0x0061,0x031A,
-		/* Latin-1 Supplement */
-		0x00E0,0x0317,
-		0x00F8,0x0307,
-		0x00FF,0x0001,0x0178,
-		/* Latin Extended-A */
-		0x0100,0x0130,
-		0x0132,0x0106,
-		0x0139,0x0110,
-		0x014A,0x012E,
-		0x0179,0x0106,
-		/* Latin Extended-B */
-		0x0180,0x004D,0x0243,0x0181,0x0182,0x0182,0x0184,0x0184,0x0186,0x0187,0x0187,0x0189,0x018A,0x018B,0x018B,0x018D,0x018E,0x018F,0x0190,0x0191,0x0191,0x0193,0x0194,0x01F6,0x0196,0x0197,0x0198,0x0198,0x023D,0x019B,0x019C,0x019D,0x0220,0x019F,0x01A0,0x01A0,0x01A2,0x01A2,0x01A4,0x01A4,0x01A6,0x01A7,0x01A7,0x01A9,0x01AA,0x01AB,0x01AC,0x01AC,0x01AE,0x01AF,0x01AF,0x01B1,0x01B2,0x01B3,0x01B3,0x01B5,0x01B5,0x01B7,0x01B8,0x01B8,0x01BA,0x01BB,0x01BC,0x01BC,0x01BE,0x01F7,0x01C0,0x01C1,0x01C2,0x01C3,0x01C4,0x01C5,0x01C4,0x01C7,0x01C8,0x01C7,0x01CA,0x01CB,0x01CA,
-		0x01CD,0x0110,
-		0x01DD,0x0001,0x018E,
-		0x01DE,0x0112,
-		0x01F3,0x0003,0x01F1,0x01F4,0x01F4,
-		0x01F8,0x0128,
-		0x0222,0x0112,
-		0x023A,0x0009,0x2C65,0x023B,0x023B,0x023D,0x2C66,0x023F,0x0240,0x0241,0x0241,
-		0x0246,0x010A,
-		/* IPA Extensions */
-		0x0253,0x0040,0x0181,0x0186,0x0255,0x0189,0x018A,0x0258,0x018F,0x025A,0x0190,0x025C,0x025D,0x025E,0x025F,0x0193,0x0261,0x0262,0x0194,0x0264,0x0265,0x0266,0x0267,0x0197,0x0196,0x026A,0x2C62,0x026C,0x026D,0x026E,0x019C,0x0270,0x0271,0x019D,0x0273,0x0274,0x019F,0x0276,0x0277,0x0278,0x0279,0x027A,0x027B,0x027C,0x2C64,0x027E,0x027F,0x01A6,0x0281,0x0282,0x01A9,0x0284,0x0285,0x0286,0x0287,0x01AE,0x0244,0x01B1,0x01B2,0x0245,0x028D,0x028E,0x028F,0x0290,0x0291,0x01B7,
-		/* Greek, Coptic */
-		0x037B,0x0003,0x03FD,0x03FE,0x03FF,
-		0x03AC,0x0004,0x0386,0x0388,0x0389,0x038A,
-		0x03B1,0x0311,
-		0x03C2,0x0002,0x03A3,0x03A3,
-		0x03C4,0x0308,
-		0x03CC,0x0003,0x038C,0x038E,0x038F,
-		0x03D8,0x0118,
-		0x03F2,0x000A,0x03F9,0x03F3,0x03F4,0x03F5,0x03F6,0x03F7,0x03F7,0x03F9,0x03FA,0x03FA,
-		/* Cyrillic */
-		0x0430,0x0320,
-		0x0450,0x0710,
-		0x0460,0x0122,
-		0x048A,0x0136,
-		0x04C1,0x010E,
-		0x04CF,0x0001,0x04C0,
-		0x04D0,0x0144,
-		/* Armenian */
-		0x0561,0x0426,
+#if FF_FAST_UPCASE == 2 && FF_FS_REENTRANT
+	const WORD *delta = __atomic_load_n(&UpcaseDelta, __ATOMIC_ACQUIRE);
+#else
+	const WORD *delta = UpcaseDelta;
+#endif
 
-		0x0000	/* EOT */
-	};
-	static const WORD cvt2[] = {	/* Compressed up conversion table for U+1000 - U+FFFF */
-		/* Phonetic Extensions */
-		0x1D7D,0x0001,0x2C63,
-		/* Latin Extended Additional */
-		0x1E00,0x0196,
-		0x1EA0,0x015A,
-		/* Greek Extended */
-		0x1F00,0x0608,
-		0x1F10,0x0606,
-		0x1F20,0x0608,
-		0x1F30,0x0608,
-		0x1F40,0x0606,
-		0x1F51,0x0007,0x1F59,0x1F52,0x1F5B,0x1F54,0x1F5D,0x1F56,0x1F5F,
-		0x1F60,0x0608,
-		0x1F70,0x000E,0x1FBA,0x1FBB,0x1FC8,0x1FC9,0x1FCA,0x1FCB,0x1FDA,0x1FDB,0x1FF8,0x1FF9,0x1FEA,0x1FEB,0x1FFA,0x1FFB,
-		0x1F80,0x0608,
-		0x1F90,0x0608,
-		0x1FA0,0x0608,
-		0x1FB0,0x0004,0x1FB8,0x1FB9,0x1FB2,0x1FBC,
-		0x1FCC,0x0001,0x1FC3,
-		0x1FD0,0x0602,
-		0x1FE0,0x0602,
-		0x1FE5,0x0001,0x1FEC,
-		0x1FF3,0x0001,0x1FFC,
-		/* Letterlike Symbols */
-		0x214E,0x0001,0x2132,
-		/* Number forms */
-		0x2170,0x0210,
-		0x2184,0x0001,0x2183,
-		/* Enclosed Alphanumerics */
-		0x24D0,0x051A,
-		0x2C30,0x042F,
-		/* Latin Extended-C */
-		0x2C60,0x0102,
-		0x2C67,0x0106, 0x2C75,0x0102,
-		/* Coptic */
-		0x2C80,0x0164,
-		/* Georgian Supplement */
-		0x2D00,0x0826,
-		/* Full-width */
-		0xFF41,0x031A,
+	if (uni < 0x80) {	/* ASCII: subtract 0x20 from 'a'-'z' without branching */
+		return uni - ((DWORD)(uni - 'a' < 26) << 5);
+	}
+#if FF_FAST_UPCASE == 2
+	if (!delta) {	/* Decode the table on first use */
+		slim_lock(&UpcaseLock);
+		if (!UpcaseDelta && !UpcaseFailed) upcase_decode();
+		delta = UpcaseDelta;
+		slim_unlock(&UpcaseLock);
+		if (!delta) return wtoupper_cvt(uni);	/* Search the compressed table if it could not be decoded */
+	}
+#endif
+	if (uni < 0x10000) {	/* Is it in BMP? */
+		uni = (WORD)(uni + delta[(UINT)UpcaseIndex[uni >> UPCASE_BLOCK_BITS] << UPCASE_BLOCK_BITS | (uni & ((1 << UPCASE_BLOCK_BITS) - 1))]);
+	}
 
-		0x0000	/* EOT */
-	};
+	return uni;
+}
+#endif
+
+#if FF_FAST_UPCASE != 1
+#if FF_FAST_UPCASE == 2
+static DWORD wtoupper_cvt (	/* Returns up-converted code point, searching the compressed table */
+#else
+/* --- END LIBSLIM PATCH: FEAT_FAST_UPCASE --- */
+DWORD ff_wtoupper (	/* Returns up-converted code point */
+/* --- BEGIN LIBSLIM PATCH: FEAT_FAST_UPCASE --- */
+#endif
+/* --- END LIBSLIM PATCH: FEAT_FAST_UPCASE --- */
+	DWORD uni		/* Unicode code point to be up-converted */
+)
+{
+	const WORD *p;
+	WORD uc, bc, nc, cmd;
 
 
 	if (uni < 0x10000) {	/* Is it in BMP? */
@@ -15588,6 +15797,9 @@ DWORD ff_wtoupper (	/* Returns up-converted code point */
 
 	return uni;
 }
+/* --- BEGIN LIBSLIM PATCH: FEAT_FAST_UPCASE --- */
+#endif
+/* --- END LIBSLIM PATCH: FEAT_FAST_UPCASE --- */
 
 
 #endif /* #if FF_USE_LFN */
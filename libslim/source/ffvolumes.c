@@ -33,6 +33,10 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 static const DISC_INTERFACE *_disc_io[FF_VOLUMES] = {NULL};
 static BOOL _disc_io_init[FF_VOLUMES] = {false};
+static WORD _disc_ssize[FF_VOLUMES] = {0};
+static LBA_t _disc_sectors[FF_VOLUMES] = {0};
+static UINT _disc_max_sectors[FF_VOLUMES] = {0};
+static FN_MEDIUM_DISCARD _disc_discard[FF_VOLUMES] = {NULL};
 
 BOOL configure_disc_io(volno_t vol, const DISC_INTERFACE *disc_io_drv)
 {
@@ -77,24 +81,164 @@ const DISC_INTERFACE *get_disc_io(volno_t vol)
     return _disc_io[vol];
 }
 
-extern int get_ldnumber(const TCHAR** path);
+BOOL configure_disc_ssize(volno_t vol, WORD ssize)
+{
+    if (!VALID_DISK(vol))
+        return false;
+    if (ssize < FF_MIN_SS || ssize > FF_MAX_SS || (ssize & (ssize - 1)))
+        return false;
+    _disc_ssize[vol] = ssize;
+    return true;
+}
+
+WORD get_disc_ssize(volno_t vol)
+{
+    if (!VALID_DISK(vol) || !_disc_ssize[vol])
+        return FF_MIN_SS;
+    return _disc_ssize[vol];
+}
+
+BOOL configure_disc_sectors(volno_t vol, LBA_t sectors)
+{
+    if (!VALID_DISK(vol))
+        return false;
+    _disc_sectors[vol] = sectors;
+    return true;
+}
+
+LBA_t get_disc_sectors(volno_t vol)
+{
+    if (!VALID_DISK(vol))
+        return 0;
+    return _disc_sectors[vol];
+}
+
+BOOL configure_disc_max_sectors(volno_t vol, UINT maxSectors)
+{
+    if (!VALID_DISK(vol))
+        return false;
+    _disc_max_sectors[vol] = maxSectors;
+    return true;
+}
+
+UINT get_disc_max_sectors(volno_t vol)
+{
+    if (!VALID_DISK(vol))
+        return 0;
+    return _disc_max_sectors[vol];
+}
+
+BOOL configure_disc_discard(volno_t vol, FN_MEDIUM_DISCARD discard)
+{
+    if (!VALID_DISK(vol))
+        return false;
+    _disc_discard[vol] = discard;
+    return true;
+}
+
+FN_MEDIUM_DISCARD get_disc_discard(volno_t vol)
+{
+    if (!VALID_DISK(vol))
+        return NULL;
+    return _disc_discard[vol];
+}
+
 extern const char* const VolumeStr[FF_VOLUMES];
 
-volno_t get_vol(const char* mount)
+// Volumes whose name starts with each letter, as a bit mask indexed by the
+// letter. Built from VolumeStr on first use.
+static WORD _vol_prefix[26] = {0};
+// Numeric path of the root of each volume, such as "0:".
+static TCHAR _vol_root[FF_VOLUMES][3] = {{0}};
+static BOOL _vol_prefix_init = false;
+
+// Racing initializations write the same values, so no lock is needed.
+static void init_vol_prefix(void)
+{
+    WORD prefix[26] = {0};
+    for (volno_t vol = 0; vol < FF_VOLUMES; vol++)
+    {
+        const char *name = VolumeStr[vol];
+        BYTE c = (BYTE)name[0] | 0x20;
+        if (c >= 'a' && c <= 'z')
+            prefix[c - 'a'] |= 1 << vol;
+        _vol_root[vol][0] = '0' + vol;
+        _vol_root[vol][1] = ':';
+    }
+    memcpy(_vol_prefix, prefix, sizeof(prefix));
+#if FF_FS_REENTRANT
+    __atomic_store_n(&_vol_prefix_init, true, __ATOMIC_RELEASE);
+#else
+    _vol_prefix_init = true;
+#endif
+}
+
+// Returns the rest of the path after the colon if it starts with the volume
+// name and a colon, or NULL. Only ASCII letters are folded, as in FatFs.
+static inline const char *match_vol_name(const char *path, const char *name)
+{
+    for (; *name; path++, name++)
+    {
+        BYTE a = *path, b = *name;
+        if (a != b && ((a | 0x20) != (b | 0x20) || (BYTE)((b | 0x20) - 'a') > 'z' - 'a'))
+            return NULL;
+    }
+    return *path == ':' ? path + 1 : NULL;
+}
+
+static inline void ensure_vol_prefix(void)
 {
-    int mnt_len = strlen(mount);
-    if (mnt_len < 2)
+#if FF_FS_REENTRANT
+    if (!__atomic_load_n(&_vol_prefix_init, __ATOMIC_ACQUIRE))
+#else
+    if (!_vol_prefix_init)
+#endif
+        init_vol_prefix();
+}
+
+volno_t get_vol_prefix(const char *path, const char **rest)
+{
+    ensure_vol_prefix();
+
+    BYTE c = (BYTE)path[0];
+    if (c >= '0' && c < '0' + FF_VOLUMES && path[1] == ':')
+    {
+        *rest = path + 2;
+        return c - '0';
+    }
+    c |= 0x20;
+    if (c < 'a' || c > 'z')
         return -1;
-    size_t len = 0;
-    char end_chr = mount[mnt_len - 1];
-    if (end_chr == ':' || (end_chr == '/' && mount[mnt_len - 2] == ':'))
+    for (UINT mask = _vol_prefix[c - 'a']; mask; mask &= mask - 1)
     {
-        const TCHAR *m = mbstoucs2(mount, &len);
-        return get_ldnumber(&m);
+        volno_t vol = __builtin_ctz(mask);
+        const char *after = match_vol_name(path, VolumeStr[vol]);
+        if (after)
+        {
+            *rest = after;
+            return vol;
+        }
     }
     return -1;
 }
 
+volno_t get_vol(const char* mount)
+{
+    const char *rest;
+    volno_t vol = get_vol_prefix(mount, &rest);
+    if (vol == -1 || (rest[0] && (rest[0] != '/' || rest[1])))
+        return -1;
+    return vol;
+}
+
+const TCHAR *get_vol_root(volno_t vol)
+{
+    if (!VALID_DISK(vol))
+        return NULL;
+    ensure_vol_prefix();
+    return _vol_root[vol];
+}
+
 const char* const get_mnt(volno_t vol)
 {
     if (!VALID_DISK(vol))
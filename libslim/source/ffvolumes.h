@@ -36,6 +36,13 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 typedef int volno_t;
 
+/**
+ * Discards numSectors sectors starting from sector, informing the device that
+ * their data is no longer used. DISC_INTERFACE has no such function, so it is
+ * configured separately for each volume.
+ */
+typedef bool (*FN_MEDIUM_DISCARD)(sec_t sector, sec_t numSectors);
+
 /**
  * Configures the IO driver for the specified volume.
  * Once configured, can never be reconfigured.
@@ -59,10 +66,25 @@ BOOL init_disc_io(volno_t vol);
 BOOL deinit_disc_io(volno_t vol);
 
 /**
- * Gets the volume number given the specified mount point.
+ * Gets the volume number given the specified mount point, such as "sd:" or "sd:/".
+ * Returns -1 if it is not the mount point of a volume.
  */
 volno_t get_vol(const char *mount);
 
+/**
+ * Gets the volume number of the volume prefix ("sd:", "fat:" or "0:") the
+ * specified path starts with, and sets rest to the rest of the path after the colon.
+ * Volume names are compared case-insensitively against the bytes of the path,
+ * without converting it. Returns -1 if the path does not start with a volume prefix.
+ */
+volno_t get_vol_prefix(const char *path, const char **rest);
+
+/**
+ * Gets the path of the root of the specified volume with the volume number as
+ * its prefix, such as "0:". FatFs resolves it without comparing volume names.
+ */
+const TCHAR *get_vol_root(volno_t vol);
+
 /**
  * Gets the mount point name (without colon) for the specified volume.
  */
@@ -73,4 +95,61 @@ const char* const get_mnt(volno_t vol);
  */
 const DISC_INTERFACE *get_disc_io(volno_t vol);
 
+/**
+ * Configures the sector size in bytes of the IO driver for the specified volume.
+ * 
+ * Returns false if the specified volume number is invalid, or the sector size is 
+ * not a power of 2 between FF_MIN_SS and FF_MAX_SS.
+ */
+BOOL configure_disc_ssize(volno_t vol, WORD ssize);
+
+/**
+ * Gets the sector size in bytes of the IO driver for the specified volume number.
+ * Defaults to FF_MIN_SS if it was never configured.
+ */
+WORD get_disc_ssize(volno_t vol);
+
+/**
+ * Configures the size in sectors of the device for the specified volume,
+ * for drivers that can not report it themselves.
+ * 
+ * Returns false if the specified volume number is invalid.
+ */
+BOOL configure_disc_sectors(volno_t vol, LBA_t sectors);
+
+/**
+ * Gets the size in sectors of the device for the specified volume number,
+ * or 0 if it was never configured.
+ */
+LBA_t get_disc_sectors(volno_t vol);
+
+/**
+ * Configures the largest number of sectors the IO driver for the specified volume
+ * accepts in a single request. Larger requests are split into requests of this size.
+ * Passing 0 removes the limit.
+ * 
+ * Returns false if the specified volume number is invalid.
+ */
+BOOL configure_disc_max_sectors(volno_t vol, UINT maxSectors);
+
+/**
+ * Gets the largest number of sectors the IO driver for the specified volume number
+ * accepts in a single request, or 0 if there is no limit.
+ */
+UINT get_disc_max_sectors(volno_t vol);
+
+/**
+ * Configures the discard function of the IO driver for the specified volume.
+ * Passing NULL disables discards.
+ * 
+ * Returns false if the specified volume number is invalid.
+ */
+BOOL configure_disc_discard(volno_t vol, FN_MEDIUM_DISCARD discard);
+
+/**
+ * Gets the discard function of the IO driver for the specified volume number,
+ * or NULL if the device does not support discards.
+ */
+FN_MEDIUM_DISCARD get_disc_discard(volno_t vol);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,56 @@
+/*
+Copyright (c) 2020, chyyran
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the copyright holder nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL CHYYRAN BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef __SLIM_LOCK_H__
+#define __SLIM_LOCK_H__
+
+#include "ff.h"
+
+// Locks for state that is shared between volumes. FatFs only locks each
+// volume, so the sector cache and the lookup caches need their own locks
+// when FF_FS_REENTRANT is enabled. Without it, locking is a no-op.
+#if FF_FS_REENTRANT
+#include <pthread.h>
+
+typedef pthread_mutex_t SLIM_LOCK;
+#define SLIM_LOCK_INIT PTHREAD_MUTEX_INITIALIZER
+
+#define slim_lock_init(lock) pthread_mutex_init(lock, NULL)
+#define slim_lock_destroy(lock) pthread_mutex_destroy(lock)
+#define slim_lock(lock) pthread_mutex_lock(lock)
+#define slim_unlock(lock) pthread_mutex_unlock(lock)
+#else
+typedef BYTE SLIM_LOCK;
+#define SLIM_LOCK_INIT 0
+
+#define slim_lock_init(lock) ((void)(lock))
+#define slim_lock_destroy(lock) ((void)(lock))
+#define slim_lock(lock) ((void)(lock))
+#define slim_unlock(lock) ((void)(lock))
+#endif
+
+#endif
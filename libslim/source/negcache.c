@@ -0,0 +1,140 @@
+/*
+Copyright (c) 2020, chyyran
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the copyright holder nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL CHYYRAN BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "negcache.h"
+#include "lock.h"
+
+#if FF_USE_NEG_CACHE
+
+typedef struct negcache_entry_s
+{
+    // NULL if this entry is unused.
+    FATFS *fs;
+    // Mount ID of fs when the entry was stored.
+    WORD id;
+    WORD len;
+    DWORD sclust;
+    DWORD hash;
+    // Up-cased name
+    WCHAR name[FF_NEG_CACHE_MAXLEN];
+} NEGCACHE_ENTRY;
+
+static NEGCACHE_ENTRY _negCache[FF_NEG_CACHE_ENTRIES];
+static UINT _replaceCounter = 0;
+static SLIM_LOCK _lock = SLIM_LOCK_INIT;
+
+static inline WCHAR fold(WCHAR c)
+{
+    if (c < 0x80)
+        return (c >= 'a' && c <= 'z') ? c - 0x20 : c;
+    return (WCHAR)ff_wtoupper(c);
+}
+
+// Hashes the up-cased name, returning its length in len.
+static DWORD name_hash(const WCHAR *name, UINT *len)
+{
+    // FNV-1a
+    DWORD hash = 0x811C9DC5;
+    UINT i;
+    for (i = 0; name[i]; i++)
+        hash = (hash ^ fold(name[i])) * 0x01000193;
+    *len = i;
+    return hash;
+}
+
+BOOL negcache_lookup(FATFS *fs, DWORD sclust, const WCHAR *name)
+{
+    UINT len;
+    DWORD hash = name_hash(name, &len);
+    if (len > FF_NEG_CACHE_MAXLEN)
+        return false;
+
+    BOOL found = false;
+    slim_lock(&_lock);
+    for (int i = 0; i < FF_NEG_CACHE_ENTRIES && !found; i++)
+    {
+        NEGCACHE_ENTRY *e = &_negCache[i];
+        if (e->fs != fs || e->hash != hash || e->sclust != sclust || e->len != len)
+            continue;
+        if (!fs->fs_type || fs->id != e->id)
+        {
+            e->fs = NULL;
+            continue;
+        }
+
+        UINT j = 0;
+        while (j < len && e->name[j] == fold(name[j]))
+            j++;
+        found = j == len;
+    }
+    slim_unlock(&_lock);
+    return found;
+}
+
+void negcache_store(FATFS *fs, DWORD sclust, const WCHAR *name)
+{
+    UINT len;
+    DWORD hash = name_hash(name, &len);
+    if (len > FF_NEG_CACHE_MAXLEN)
+        return;
+
+    slim_lock(&_lock);
+    NEGCACHE_ENTRY *e = &_negCache[_replaceCounter];
+    _replaceCounter = (_replaceCounter + 1) % FF_NEG_CACHE_ENTRIES;
+
+    for (UINT j = 0; j < len; j++)
+        e->name[j] = fold(name[j]);
+    e->fs = fs;
+    e->id = fs->id;
+    e->len = len;
+    e->sclust = sclust;
+    e->hash = hash;
+    slim_unlock(&_lock);
+}
+
+void negcache_drop(FATFS *fs, DWORD sclust)
+{
+    slim_lock(&_lock);
+    for (int i = 0; i < FF_NEG_CACHE_ENTRIES; i++)
+    {
+        if (_negCache[i].fs == fs && _negCache[i].sclust == sclust)
+            _negCache[i].fs = NULL;
+    }
+    slim_unlock(&_lock);
+}
+
+void negcache_drop_volume(FATFS *fs)
+{
+    slim_lock(&_lock);
+    for (int i = 0; i < FF_NEG_CACHE_ENTRIES; i++)
+    {
+        if (_negCache[i].fs == fs)
+            _negCache[i].fs = NULL;
+    }
+    slim_unlock(&_lock);
+}
+#endif
@@ -0,0 +1,63 @@
+/*
+Copyright (c) 2020, chyyran
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the copyright holder nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL CHYYRAN BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef __SLIM_NEGCACHE_H__
+#define __SLIM_NEGCACHE_H__
+
+#include "ff.h"
+
+#if FF_USE_NEG_CACHE
+
+/**
+ * Returns true if name is known not to exist in the directory starting at sclust.
+ *
+ * name is the segment name as parsed by FatFs, and is compared case-insensitively.
+ */
+BOOL negcache_lookup(FATFS *fs, DWORD sclust, const WCHAR *name);
+
+/**
+ * Records that name does not exist in the directory starting at sclust.
+ *
+ * Names longer than FF_NEG_CACHE_MAXLEN are not cached. When the cache is full,
+ * the oldest entry is replaced.
+ */
+void negcache_store(FATFS *fs, DWORD sclust, const WCHAR *name);
+
+/**
+ * Drops every entry of the directory starting at sclust.
+ *
+ * This must be called whenever an entry is created in the directory.
+ */
+void negcache_drop(FATFS *fs, DWORD sclust);
+
+/**
+ * Drops every entry of the specified volume.
+ */
+void negcache_drop_volume(FATFS *fs);
+
+#endif
+#endif
@@ -0,0 +1,202 @@
+/*
+Copyright (c) 2020, chyyran
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the copyright holder nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL CHYYRAN BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "pathcache.h"
+#include "memcopy.h"
+#include "lock.h"
+
+#if FF_USE_PATH_CACHE
+
+// Deepest directory prefix looked up in a path.
+#define PATHCACHE_MAX_DEPTH 16
+
+#define IS_SEPARATOR(c) ((c) == '/' || (c) == '\\')
+
+typedef struct pathcache_entry_s
+{
+    // NULL if this entry is unused.
+    FATFS *fs;
+    // Mount ID of fs when the entry was stored.
+    WORD id;
+    WORD len;
+    DWORD base;
+    DWORD hash;
+    // Value of _useCounter on last access, for LRU eviction
+    DWORD lastUse;
+    PATHCACHE_DIR dir;
+    // Case-folded prefix, with each run of separators stored as a single '/'
+    WCHAR name[FF_PATH_CACHE_MAXLEN];
+} PATHCACHE_ENTRY;
+
+static PATHCACHE_ENTRY _pathCache[FF_PATH_CACHE_ENTRIES];
+static DWORD _useCounter = 0;
+static SLIM_LOCK _lock = SLIM_LOCK_INIT;
+
+static inline WCHAR fold(TCHAR tc)
+{
+    WCHAR c = (WCHAR)tc;
+    if (IS_SEPARATOR(c))
+        return '/';
+    if (c < 0x80)
+        return (c >= 'a' && c <= 'z') ? c - 0x20 : c;
+#if FF_LFN_UNICODE == 1
+    return (WCHAR)ff_wtoupper(c);
+#else
+    // Multi-byte characters are compared as-is.
+    return c;
+#endif
+}
+
+static inline DWORD hash_step(DWORD hash, WCHAR c)
+{
+    // FNV-1a
+    return (hash ^ c) * 0x01000193;
+}
+
+// Compares the folded name of e with the first len characters of path.
+static BOOL entry_matches(const PATHCACHE_ENTRY *e, const TCHAR *path, UINT len)
+{
+    UINT n = 0;
+    for (UINT i = 0; i < len; i++)
+    {
+        if (IS_SEPARATOR(path[i]) && i > 0 && IS_SEPARATOR(path[i - 1]))
+            continue;
+        if (n >= e->len || e->name[n++] != fold(path[i]))
+            return false;
+    }
+    return n == e->len;
+}
+
+UINT pathcache_lookup(FATFS *fs, DWORD base, const TCHAR *path, PATHCACHE_DIR *dir)
+{
+    DWORD hashes[PATHCACHE_MAX_DEPTH];
+    UINT ends[PATHCACHE_MAX_DEPTH];
+    UINT depth = 0;
+    DWORD hash = 0x811C9DC5;
+    UINT n = 0;
+
+    // Record the hash of every prefix ending after a run of separators.
+    // A prefix is only complete if another segment follows it.
+    for (UINT i = 0; path[i] >= ' ' && n <= FF_PATH_CACHE_MAXLEN; i++)
+    {
+        if (IS_SEPARATOR(path[i]))
+        {
+            if (i > 0 && IS_SEPARATOR(path[i - 1]))
+                continue;
+            hash = hash_step(hash, '/');
+            n++;
+            continue;
+        }
+        if (i > 0 && IS_SEPARATOR(path[i - 1]) && n <= FF_PATH_CACHE_MAXLEN)
+        {
+            if (depth == PATHCACHE_MAX_DEPTH)
+                break;
+            hashes[depth] = hash;
+            ends[depth++] = i;
+        }
+        hash = hash_step(hash, fold(path[i]));
+        n++;
+    }
+
+    slim_lock(&_lock);
+    while (depth--)
+    {
+        for (int i = 0; i < FF_PATH_CACHE_ENTRIES; i++)
+        {
+            PATHCACHE_ENTRY *e = &_pathCache[i];
+            if (e->fs != fs || e->hash != hashes[depth] || e->base != base)
+                continue;
+            if (!fs->fs_type || fs->id != e->id)
+            {
+                e->fs = NULL;
+                continue;
+            }
+            if (!entry_matches(e, path, ends[depth]))
+                continue;
+            e->lastUse = ++_useCounter;
+            *dir = e->dir;
+            slim_unlock(&_lock);
+            return ends[depth];
+        }
+    }
+    slim_unlock(&_lock);
+    return 0;
+}
+
+void pathcache_store(FATFS *fs, DWORD base, const TCHAR *path, UINT len, const PATHCACHE_DIR *dir)
+{
+    slim_lock(&_lock);
+    PATHCACHE_ENTRY *victim = &_pathCache[0];
+    for (int i = 0; i < FF_PATH_CACHE_ENTRIES; i++)
+    {
+        PATHCACHE_ENTRY *e = &_pathCache[i];
+        if (!e->fs || !e->fs->fs_type || e->fs->id != e->id)
+        {
+            victim = e;
+            break;
+        }
+        if ((DWORD)(_useCounter - e->lastUse) > (DWORD)(_useCounter - victim->lastUse))
+            victim = e;
+    }
+
+    DWORD hash = 0x811C9DC5;
+    UINT n = 0;
+    for (UINT i = 0; i < len; i++)
+    {
+        if (IS_SEPARATOR(path[i]) && i > 0 && IS_SEPARATOR(path[i - 1]))
+            continue;
+        if (n == FF_PATH_CACHE_MAXLEN)
+        {
+            victim->fs = NULL;
+            slim_unlock(&_lock);
+            return;
+        }
+        victim->name[n++] = fold(path[i]);
+        hash = hash_step(hash, victim->name[n - 1]);
+    }
+
+    victim->fs = fs;
+    victim->id = fs->id;
+    victim->len = n;
+    victim->base = base;
+    victim->hash = hash;
+    victim->lastUse = ++_useCounter;
+    victim->dir = *dir;
+    slim_unlock(&_lock);
+}
+
+void pathcache_drop_volume(FATFS *fs)
+{
+    slim_lock(&_lock);
+    for (int i = 0; i < FF_PATH_CACHE_ENTRIES; i++)
+    {
+        if (_pathCache[i].fs == fs)
+            _pathCache[i].fs = NULL;
+    }
+    slim_unlock(&_lock);
+}
+#endif
@@ -0,0 +1,76 @@
+/*
+Copyright (c) 2020, chyyran
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the copyright holder nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL CHYYRAN BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef __SLIM_PATHCACHE_H__
+#define __SLIM_PATHCACHE_H__
+
+#include "ff.h"
+
+#if FF_USE_PATH_CACHE
+
+/**
+ * A directory reached by a cached path prefix.
+ */
+typedef struct pathcache_dir_s
+{
+    // Start cluster of the directory
+    DWORD sclust;
+#if FF_FS_EXFAT
+    // Location of the directory entry on exFAT volumes. The allocation
+    // information of the directory is reloaded from the entry on a hit,
+    // since it changes as the directory grows.
+    DWORD c_scl;
+    DWORD c_size;
+    DWORD c_ofs;
+#endif
+} PATHCACHE_DIR;
+
+/**
+ * Finds the longest cached directory prefix of path, not including its last segment.
+ *
+ * base is the start cluster the path is relative to, 0 for the root directory.
+ * On a hit, the directory is written to dir and the number of characters of path
+ * covered by the prefix is returned, including trailing separators.
+ * Returns 0 if no prefix of path is cached.
+ */
+UINT pathcache_lookup(FATFS *fs, DWORD base, const TCHAR *path, PATHCACHE_DIR *dir);
+
+/**
+ * Caches the directory reached by the first len characters of path from base.
+ *
+ * Prefixes longer than FF_PATH_CACHE_MAXLEN are not cached. When the cache is
+ * full, the least recently used prefix is replaced.
+ */
+void pathcache_store(FATFS *fs, DWORD base, const TCHAR *path, UINT len, const PATHCACHE_DIR *dir);
+
+/**
+ * Drops every cached prefix of the specified volume.
+ */
+void pathcache_drop_volume(FATFS *fs);
+
+#endif
+#endif
@@ -0,0 +1,102 @@
+/*
+Copyright (c) 2020, chyyran
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the copyright holder nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL CHYYRAN BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+// Measures the hit throughput of the sector cache from several threads, which
+// only scales with the number of threads on a host with as many CPUs.
+// Built and run on the host by `make bench` with FF_FS_REENTRANT=1.
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "cache.h"
+#include "host.h"
+
+#if !FF_FS_REENTRANT
+#error bench_cache must be built with FF_FS_REENTRANT=1
+#endif
+
+#define MAX_THREADS 8
+#define HOT_SECTORS 128
+#define CACHE_SECTORS 256
+#define LOOKUPS 2000000
+
+static CACHE *_cache;
+
+static void *worker(void *arg)
+{
+    unsigned seed = (unsigned)(long)arg * 31 + 7;
+    BYTE buf[512] __attribute__((aligned(4)));
+    for (long i = 0; i < LOOKUPS; i++)
+    {
+        LBA_t sector = 1000 + rand_r(&seed) % HOT_SECTORS;
+        if (!cache_load_sector(_cache, 0, sector, buf) || buf[0] != (BYTE)sector)
+        {
+            fprintf(stderr, "missed or torn sector %lu\n", (unsigned long)sector);
+            exit(1);
+        }
+    }
+    return NULL;
+}
+
+// Returns the hits per second of the given number of threads.
+static double run(int threads)
+{
+    pthread_t t[MAX_THREADS];
+    double start = bench_time();
+    for (int i = 0; i < threads; i++)
+        pthread_create(&t[i], NULL, worker, (void *)(long)i);
+    for (int i = 0; i < threads; i++)
+        pthread_join(t[i], NULL);
+    return (double)threads * LOOKUPS / (bench_time() - start);
+}
+
+int main(void)
+{
+    BYTE buf[512] __attribute__((aligned(4)));
+
+    _cache = cache_init(CACHE_SECTORS);
+    if (_cache == NULL)
+        return 1;
+    for (LBA_t sector = 1000; sector < 1000 + HOT_SECTORS; sector++)
+    {
+        memset(buf, (BYTE)sector, sizeof(buf));
+        cache_store_sector(_cache, 0, sector, buf, sizeof(buf), 1);
+    }
+
+    printf("%ld CPUs, %d shards\n", sysconf(_SC_NPROCESSORS_ONLN), SLIM_CACHE_SHARDS);
+    double base = run(1);
+    printf("1 thread   %6.2f M hits/s\n", base / 1e6);
+    for (int threads = 2; threads <= MAX_THREADS; threads *= 2)
+    {
+        double hits = run(threads);
+        printf("%d threads  %6.2f M hits/s  %.2fx\n", threads, hits / 1e6, hits / base);
+    }
+    return 0;
+}
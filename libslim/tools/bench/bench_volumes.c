@@ -0,0 +1,161 @@
+/*
+Copyright (c) 2020, chyyran
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the copyright holder nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL CHYYRAN BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+// Runs a mixed file workload on fat: and sd: from several threads, and prints
+// how much faster it completes than on one thread. The RAM disks sleep like an
+// SD card on every request, so threads on different volumes overlap their I/O
+// even on a single CPU. Threads on one volume are serialized by its lock.
+// Built and run on the host by `make bench` with FF_FS_REENTRANT=1.
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ff.h"
+#include "ffvolumes.h"
+#include "host.h"
+
+#if !FF_FS_REENTRANT
+#error bench_volumes must be built with FF_FS_REENTRANT=1
+#endif
+
+#define MAX_THREADS 8
+#define FILES 20
+#define ITERATIONS 300
+// 64 MiB
+#define DISK_SECTORS (128 * 1024)
+
+static const char *const _vols[2] = {"fat:", "sd:"};
+
+#define CHECK(x)                                                          \
+    do                                                                    \
+    {                                                                     \
+        if (!(x))                                                         \
+        {                                                                 \
+            fprintf(stderr, "%s:%d: %s failed\n", __FILE__, __LINE__, #x); \
+            exit(1);                                                      \
+        }                                                                 \
+    } while (0)
+
+// Creates, writes, stats, reads and deletes files in its own directory, with
+// lookups of missing names and directory listings in between.
+static void *worker(void *arg)
+{
+    int id = (int)(long)arg;
+    const char *vol = _vols[id % 2];
+    unsigned seed = id * 7 + 1;
+    static __thread BYTE data[20000], readBack[20000];
+    char path[64];
+    TCHAR tpath[64];
+    FILINFO fi;
+    FIL fil;
+    DIR dir;
+    UINT n;
+
+    snprintf(path, sizeof(path), "%s/t%d", vol, id);
+    FRESULT res = f_mkdir(bench_path(tpath, path));
+    CHECK(res == FR_OK || res == FR_EXIST);
+
+    for (int i = 0; i < ITERATIONS; i++)
+    {
+        int k = rand_r(&seed) % FILES;
+        UINT len = rand_r(&seed) % sizeof(data);
+        for (UINT j = 0; j < len; j++)
+            data[j] = (BYTE)(k + j * id);
+
+        snprintf(path, sizeof(path), "%s/t%d/Long file name %d.bin", vol, id, k);
+        bench_path(tpath, path);
+        CHECK(f_open(&fil, tpath, FA_WRITE | FA_CREATE_ALWAYS) == FR_OK);
+        CHECK(f_write(&fil, data, len, &n) == FR_OK && n == len);
+        CHECK(f_close(&fil) == FR_OK);
+        CHECK(f_stat(tpath, &fi) == FR_OK && fi.fsize == len);
+        CHECK(f_open(&fil, tpath, FA_READ) == FR_OK);
+        CHECK(f_read(&fil, readBack, sizeof(readBack), &n) == FR_OK && n == len);
+        CHECK(memcmp(readBack, data, len) == 0);
+        CHECK(f_close(&fil) == FR_OK);
+        if (i % 5 == 0)
+            CHECK(f_unlink(tpath) == FR_OK);
+
+        TCHAR missing[64];
+        snprintf(path, sizeof(path), "%s/t%d/missing %d.cfg", vol, id, k);
+        CHECK(f_stat(bench_path(missing, path), &fi) == FR_NO_FILE);
+
+        if (i % 7 == 0)
+        {
+            snprintf(path, sizeof(path), "%s/t%d", vol, id);
+            CHECK(f_opendir(&dir, bench_path(tpath, path)) == FR_OK);
+            while (f_readdir(&dir, &fi) == FR_OK && fi.fname[0])
+                ;
+            CHECK(f_closedir(&dir) == FR_OK);
+        }
+    }
+    return NULL;
+}
+
+// Runs the workload on the given number of threads, on both volumes or on
+// fat: only, and returns the time it took.
+static double run(int threads, int volumes)
+{
+    pthread_t t[MAX_THREADS];
+    double start = bench_time();
+    for (int i = 0; i < threads; i++)
+        pthread_create(&t[i], NULL, worker, (void *)(long)(volumes == 2 ? i : i * 2));
+    for (int i = 0; i < threads; i++)
+        pthread_join(t[i], NULL);
+    return bench_time() - start;
+}
+
+int main(void)
+{
+    static FATFS fs[2];
+    TCHAR tpath[16];
+
+    for (int v = 0; v < 2; v++)
+    {
+        configure_disc_io(v, ramdisk_create(DISK_SECTORS, true));
+        configure_disc_sectors(v, DISK_SECTORS);
+        ramdisk_format(_vols[v]);
+        CHECK(f_mount(&fs[v], bench_path(tpath, _vols[v]), 1) == FR_OK);
+    }
+
+    static const struct
+    {
+        int threads, volumes;
+    } runs[] = {{2, 1}, {2, 2}, {4, 2}, {8, 2}};
+
+    double base = run(1, 1);
+    printf("%-22s %8.2f s\n", "1 thread", base);
+    for (size_t i = 0; i < sizeof(runs) / sizeof(runs[0]); i++)
+    {
+        int threads = runs[i].threads, volumes = runs[i].volumes;
+        double t = run(threads, volumes);
+        printf("%d threads, %d volume%s  %8.2f s  %.2fx\n", threads, volumes, volumes == 1 ? " " : "s", t,
+               threads * base / t);
+    }
+    return 0;
+}
@@ -0,0 +1,158 @@
+/*
+Copyright (c) 2020, chyyran
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the copyright holder nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL CHYYRAN BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+// libnds functions used by the sources, and RAM disks with an SD card-like
+// latency, for building the benchmarks on the host.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <nds/bios.h>
+#include <nds/debug.h>
+
+#include "cache.h"
+#include "host.h"
+
+#define MAX_DISKS 4
+
+typedef struct ramdisk_s
+{
+    BYTE *data;
+    sec_t sectors;
+    bool latency;
+} RAMDISK;
+
+static RAMDISK _disks[MAX_DISKS];
+
+void swiDelay(uint32_t duration)
+{
+    (void)duration;
+}
+
+void nocashMessage(const char *message)
+{
+    (void)message;
+}
+
+void cache_cpy(const void *src, const void *dst, UINT size)
+{
+    memcpy((void *)dst, src, size);
+}
+
+// A fixed cost of 20 us per request, and 5 us per sector.
+static void ramdisk_wait(RAMDISK *disk, sec_t count)
+{
+    if (!disk->latency)
+        return;
+    long ns = 20000 + 5000L * count;
+    struct timespec t = {ns / 1000000000, ns % 1000000000};
+    nanosleep(&t, NULL);
+}
+
+static bool ramdisk_read(RAMDISK *disk, sec_t sector, sec_t count, void *buffer)
+{
+    if (sector + count > disk->sectors)
+        return false;
+    ramdisk_wait(disk, count);
+    memcpy(buffer, disk->data + (size_t)sector * 512, (size_t)count * 512);
+    return true;
+}
+
+static bool ramdisk_write(RAMDISK *disk, sec_t sector, sec_t count, const void *buffer)
+{
+    if (sector + count > disk->sectors)
+        return false;
+    ramdisk_wait(disk, count);
+    memcpy(disk->data + (size_t)sector * 512, buffer, (size_t)count * 512);
+    return true;
+}
+
+static bool ramdisk_ok(void)
+{
+    return true;
+}
+
+// DISC_INTERFACE has no context pointer, so each disk has its own functions.
+#define RAMDISK_IO(n)                                                                                      \
+    static bool ramdisk_read##n(sec_t s, sec_t c, void *b) { return ramdisk_read(&_disks[n], s, c, b); }        \
+    static bool ramdisk_write##n(sec_t s, sec_t c, const void *b) { return ramdisk_write(&_disks[n], s, c, b); } \
+    static const DISC_INTERFACE _io##n = {0, FEATURE_MEDIUM_CANREAD | FEATURE_MEDIUM_CANWRITE, ramdisk_ok,   \
+                                          ramdisk_ok, ramdisk_read##n, ramdisk_write##n, ramdisk_ok, ramdisk_ok};
+
+RAMDISK_IO(0)
+RAMDISK_IO(1)
+RAMDISK_IO(2)
+RAMDISK_IO(3)
+
+static const DISC_INTERFACE *const _io[MAX_DISKS] = {&_io0, &_io1, &_io2, &_io3};
+
+const DISC_INTERFACE *ramdisk_create(sec_t sectors, bool latency)
+{
+    for (int i = 0; i < MAX_DISKS; i++)
+    {
+        if (_disks[i].data == NULL)
+        {
+            _disks[i].data = calloc(sectors, 512);
+            if (_disks[i].data == NULL)
+                break;
+            _disks[i].sectors = sectors;
+            _disks[i].latency = latency;
+            return _io[i];
+        }
+    }
+    fprintf(stderr, "can not create a RAM disk\n");
+    exit(1);
+}
+
+void ramdisk_format(const char *path)
+{
+    static BYTE work[FF_MAX_SS * 8];
+    TCHAR buf[64];
+    MKFS_PARM opt = {FM_ANY | FM_SFD, 0, 0, 0, 0};
+    if (f_mkfs(bench_path(buf, path), &opt, work, sizeof(work)) != FR_OK)
+    {
+        fprintf(stderr, "can not format %s\n", path);
+        exit(1);
+    }
+}
+
+const TCHAR *bench_path(TCHAR *buf, const char *path)
+{
+    int i = 0;
+    while ((buf[i] = (TCHAR)path[i]) != 0)
+        i++;
+    return buf;
+}
+
+double bench_time(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec / 1e9;
+}
@@ -0,0 +1,50 @@
+/*
+Copyright (c) 2020, chyyran
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the copyright holder nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL CHYYRAN BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef __SLIM_BENCH_HOST_H__
+#define __SLIM_BENCH_HOST_H__
+
+#include <nds/disc_io.h>
+
+#include "ff.h"
+
+// Creates a RAM disk of the given number of 512 byte sectors. When latency is
+// set, every request sleeps as long as a request to an SD card would take, so
+// that threads waiting on different disks overlap as they would on hardware.
+const DISC_INTERFACE *ramdisk_create(sec_t sectors, bool latency);
+
+// Formats the volume at path, which must not be mounted. The sector count of
+// its disk must have been set with configure_disc_sectors.
+void ramdisk_format(const char *path);
+
+// Copies an ASCII path into buf as a TCHAR string.
+const TCHAR *bench_path(TCHAR *buf, const char *path);
+
+// Seconds on a monotonic clock.
+double bench_time(void);
+
+#endif
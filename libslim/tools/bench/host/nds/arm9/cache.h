@@ -0,0 +1,19 @@
+// Host stand-in for the libnds header of the same name, for the benchmarks.
+#ifndef NDS_ARM9_CACHE_INCLUDE
+#define NDS_ARM9_CACHE_INCLUDE
+
+#include <stdint.h>
+
+static inline void DC_FlushRange(const void *base, uint32_t size)
+{
+    (void)base;
+    (void)size;
+}
+
+static inline void DC_InvalidateRange(const void *base, uint32_t size)
+{
+    (void)base;
+    (void)size;
+}
+
+#endif
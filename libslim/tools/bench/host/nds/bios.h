@@ -0,0 +1,9 @@
+// Host stand-in for the libnds header of the same name, for the benchmarks.
+#ifndef NDS_BIOS_INCLUDE
+#define NDS_BIOS_INCLUDE
+
+#include <stdint.h>
+
+void swiDelay(uint32_t duration);
+
+#endif
@@ -0,0 +1,7 @@
+// Host stand-in for the libnds header of the same name, for the benchmarks.
+#ifndef NDS_DEBUG_INCLUDE
+#define NDS_DEBUG_INCLUDE
+
+void nocashMessage(const char *message);
+
+#endif
@@ -0,0 +1,17 @@
+// Host stand-in for the libnds header of the same name, for the benchmarks.
+#ifndef NDS_INTERRUPTS_INCLUDE
+#define NDS_INTERRUPTS_INCLUDE
+
+#include <nds/ndstypes.h>
+
+static inline int enterCriticalSection(void)
+{
+    return 0;
+}
+
+static inline void leaveCriticalSection(int oldIME)
+{
+    (void)oldIME;
+}
+
+#endif
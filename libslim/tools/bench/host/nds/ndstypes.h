@@ -0,0 +1,15 @@
+// Host stand-in for the libnds header of the same name, for the benchmarks.
+#ifndef NDS_NDSTYPES_INCLUDE
+#define NDS_NDSTYPES_INCLUDE
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define DTCM_DATA
+#define ITCM_CODE
+
+typedef uint8_t u8;
+typedef uint16_t u16;
+typedef uint32_t u32;
+
+#endif
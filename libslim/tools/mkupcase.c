@@ -0,0 +1,95 @@
+/*
+Copyright (c) 2020, chyyran
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the copyright holder nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL CHYYRAN BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+// Generates ffupcase.h, the two-level up-case table of ff_wtoupper, from the
+// compressed table in ffunicode.c. Built and run on the host by `make upcase`
+// with FF_FAST_UPCASE=0, so that ff_wtoupper searches the compressed table.
+
+#include <stdio.h>
+#include <string.h>
+
+#include "ff.h"
+
+#if FF_FAST_UPCASE
+#error mkupcase must be built with FF_FAST_UPCASE=0
+#endif
+
+// Number of characters per block. Blocks with the same deltas are stored once.
+#define BLOCK_BITS 5
+#define BLOCK_SIZE (1 << BLOCK_BITS)
+#define BLOCKS (0x10000 / BLOCK_SIZE)
+
+static WORD _delta[0x10000];
+static WORD _unique[BLOCKS];
+static BYTE _index[BLOCKS];
+
+int main(void)
+{
+    UINT count = 0;
+    for (DWORD c = 0; c < 0x10000; c++)
+        _delta[c] = (WORD)(ff_wtoupper(c) - c);
+
+    for (UINT b = 0; b < BLOCKS; b++)
+    {
+        UINT i;
+        for (i = 0; i < count; i++)
+        {
+            if (!memcmp(&_delta[_unique[i] * BLOCK_SIZE], &_delta[b * BLOCK_SIZE], BLOCK_SIZE * sizeof(WORD)))
+                break;
+        }
+        if (i == count)
+        {
+            if (count == 256)
+            {
+                fprintf(stderr, "mkupcase: more than 256 unique blocks\n");
+                return 1;
+            }
+            _unique[count++] = b;
+        }
+        _index[b] = (BYTE)i;
+    }
+
+    printf("/* Generated by tools/mkupcase.c from the compressed up-case table in ffunicode.c. Do not edit. */\n\n");
+    printf("#define UPCASE_BLOCK_BITS\t%d\n\n", BLOCK_BITS);
+
+    printf("static const BYTE UpcaseIndex[] = {\t/* Block of the deltas of each %d characters */\n", BLOCK_SIZE);
+    for (UINT b = 0; b < BLOCKS; b++)
+        printf("%s0x%02X,%s", b % 16 ? "" : "\t", _index[b], b % 16 == 15 ? "\n" : "");
+    printf("};\n\n");
+
+    printf("static const WORD UpcaseDelta[] = {\t/* Up-cased character - character, modulo 0x10000 */\n");
+    for (UINT i = 0; i < count; i++)
+    {
+        for (UINT j = 0; j < BLOCK_SIZE; j++)
+            printf("%s0x%04X,%s", j % 16 ? "" : "\t", _delta[_unique[i] * BLOCK_SIZE + j], j % 16 == 15 ? "\n" : "");
+    }
+    printf("};\n");
+
+    fprintf(stderr, "mkupcase: %u blocks, %u bytes\n", count, (unsigned)(BLOCKS + count * BLOCK_SIZE * sizeof(WORD)));
+    return 0;
+}